@@ -0,0 +1,129 @@
+// CPU 颜色转换基准：每种转换、每套本机支持的实现 (标量/NEON/SSE2/AVX2) 各跑一遍，
+// 打印 Mpix/s (按输出像素算) 和相对标量的加速比，并且逐字节对比 SIMD 和标量的输出。
+//
+//   ./cpu_convert_bench [每项最少跑多少毫秒, 默认 300]
+//
+// 有不一致的话返回 1。
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "video/cpu_convert.h"
+
+using namespace std;
+
+enum ConvertKind {
+    CONVERT_YUYV_TO_NV12,
+    CONVERT_RGB_TO_NV12,
+    CONVERT_NV12_TO_RGB,
+};
+
+struct BenchCase {
+    ConvertKind kind;
+    const char* name;
+    int src_w, src_h;
+    int dst_w, dst_h;
+};
+
+static const BenchCase CASES[] = {
+    {CONVERT_YUYV_TO_NV12, "yuyv->nv12", 1280, 720, 1280, 720},
+    {CONVERT_YUYV_TO_NV12, "yuyv->nv12", 1920, 1080, 1920, 1080},
+    {CONVERT_RGB_TO_NV12,  "rgb->nv12",  1280, 720, 1280, 720},
+    {CONVERT_RGB_TO_NV12,  "rgb->nv12",  1920, 1080, 1920, 1080},
+    {CONVERT_NV12_TO_RGB,  "nv12->rgb",  1280, 720, 1280, 720},
+    {CONVERT_NV12_TO_RGB,  "nv12->rgb",  1920, 1080, 640, 360},
+};
+
+static const CpuIsa ISAS[] = {CPU_ISA_SCALAR, CPU_ISA_NEON, CPU_ISA_SSE2, CPU_ISA_AVX2};
+
+static size_t src_bytes(const BenchCase& c) {
+    switch (c.kind) {
+    case CONVERT_YUYV_TO_NV12: return (size_t)c.src_w * c.src_h * 2;
+    case CONVERT_RGB_TO_NV12:  return (size_t)c.src_w * c.src_h * 3;
+    default:                   return (size_t)c.src_w * c.src_h * 3 / 2;
+    }
+}
+
+static size_t dst_bytes(const BenchCase& c) {
+    return (c.kind == CONVERT_NV12_TO_RGB) ? (size_t)c.dst_w * c.dst_h * 3 : (size_t)c.dst_w * c.dst_h * 3 / 2;
+}
+
+static void run_once(const BenchCase& c, const uint8_t* src, uint8_t* dst, CpuIsa isa, CpuScaleCache* cache) {
+    switch (c.kind) {
+    case CONVERT_YUYV_TO_NV12:
+        cpu_yuyv_to_nv12(src, c.src_w * 2, c.src_w, c.src_h,
+                         dst, c.dst_w, dst + (size_t)c.dst_w * c.dst_h, c.dst_w, isa);
+        break;
+    case CONVERT_RGB_TO_NV12:
+        cpu_rgb_to_nv12(src, c.src_w * 3, c.src_w, c.src_h,
+                        dst, c.dst_w, dst + (size_t)c.dst_w * c.dst_h, c.dst_w, isa);
+        break;
+    case CONVERT_NV12_TO_RGB:
+        cpu_nv12_to_rgb(src, c.src_w, src + (size_t)c.src_w * c.src_h, c.src_w, c.src_w, c.src_h,
+                        dst, c.dst_w * 3, c.dst_w, c.dst_h, isa, cache);
+        break;
+    }
+}
+
+// 至少跑 min_ms 毫秒 (至少 3 次)，返回 Mpix/s
+static double measure(const BenchCase& c, const uint8_t* src, uint8_t* dst, CpuIsa isa, int min_ms) {
+    CpuScaleCache cache;
+    run_once(c, src, dst, isa, &cache);   // 预热 (顺便建好采样表)
+
+    auto start = chrono::steady_clock::now();
+    double elapsed_ms = 0;
+    int iterations = 0;
+    while (iterations < 3 || elapsed_ms < min_ms) {
+        run_once(c, src, dst, isa, &cache);
+        iterations++;
+        elapsed_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+    double pixels = (double)c.dst_w * c.dst_h * iterations;
+    return pixels / (elapsed_ms * 1000.0);
+}
+
+int main(int argc, char** argv) {
+    int min_ms = (argc > 1) ? atoi(argv[1]) : 300;
+    if (min_ms <= 0) min_ms = 1;
+
+    printf(">>[Bench] CPU 颜色转换，本机最快的实现: %s\n", cpu_isa_name(CPU_ISA_AUTO));
+    printf("%-12s %-24s %-8s %10s %8s  %s\n", "转换", "尺寸", "实现", "Mpix/s", "加速比", "和标量对比");
+
+    int mismatches = 0;
+    srand(1);
+    for (const BenchCase& c : CASES) {
+        vector<uint8_t> src(src_bytes(c));
+        for (uint8_t& b : src) b = (uint8_t)rand();
+        vector<uint8_t> reference(dst_bytes(c));
+        vector<uint8_t> out(dst_bytes(c));
+
+        char size_str[64];
+        snprintf(size_str, sizeof(size_str), "%dx%d -> %dx%d", c.src_w, c.src_h, c.dst_w, c.dst_h);
+
+        double scalar_mpix = 0;
+        for (CpuIsa isa : ISAS) {
+            if (!cpu_isa_supported(isa)) continue;
+            vector<uint8_t>& dst = (isa == CPU_ISA_SCALAR) ? reference : out;
+            double mpix = measure(c, src.data(), dst.data(), isa, min_ms);
+
+            const char* verdict = "-";
+            if (isa == CPU_ISA_SCALAR) {
+                scalar_mpix = mpix;
+            } else if (out == reference) {
+                verdict = "一致";
+            } else {
+                verdict = "不一致!";
+                mismatches++;
+            }
+            printf("%-12s %-24s %-8s %10.1f %7.2fx  %s\n",
+                   c.name, size_str, cpu_isa_name(isa), mpix, mpix / scalar_mpix, verdict);
+        }
+    }
+
+    if (mismatches) {
+        printf(">>[Bench] %d 项 SIMD 输出和标量不一致\n", mismatches);
+        return 1;
+    }
+    printf(">>[Bench] 所有 SIMD 输出和标量逐字节一致\n");
+    return 0;
+}
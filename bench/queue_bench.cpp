@@ -0,0 +1,179 @@
+// 队列微基准：SpscPacketRing 对比 MediaPacketQueue
+// 一个生产者线程、一个消费者线程，推 N 个大小接近实际码流的包
+// (30fps H.264：每 60 帧一个大 I 帧，其余 P 帧，中间穿插 AAC 帧)，
+// 统计吞吐 (包/秒)、入队到出队的延迟、丢包数。
+//
+//   ./queue_bench [包数, 默认 200000] [生产间隔 us, 默认 0 = 不限速]
+//
+// 不限速时测的是极限吞吐 (队列满了会丢包)；给间隔 (比如 33) 时测的是正常负载下的延迟。
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "safe_queue.h"
+#include "spsc_ring.h"
+
+using namespace std;
+
+static const size_t QUEUE_PACKETS = 64;                 // 两种队列的深度一样
+static const size_t RING_SLAB_BYTES = 8 * 1024 * 1024;  // 装得下 64 个大 I 帧
+
+struct BenchPacket {
+    size_t size;
+    uint32_t timestamp;
+    bool keyframe;
+    MediaType type;
+};
+
+struct BenchResult {
+    double seconds = 0;
+    uint64_t received = 0;
+    uint64_t dropped = 0;
+    double lat_avg_us = 0;
+    double lat_p50_us = 0;
+    double lat_p99_us = 0;
+    double lat_max_us = 0;
+};
+
+static int64_t now_ns() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 包序列：视频 30fps，每 3 帧视频插 2 个 AAC 帧 (~43 帧/秒)
+static vector<BenchPacket> make_packets(size_t n) {
+    vector<BenchPacket> packets;
+    packets.reserve(n);
+    srand(1);
+    uint32_t video_frame = 0, audio_frame = 0;
+    while (packets.size() < n) {
+        BenchPacket p;
+        if (packets.size() % 5 == 1 || packets.size() % 5 == 3) {
+            p.size = 300 + rand() % 200;
+            p.timestamp = audio_frame++ * 1024 * 1000 / 44100;
+            p.keyframe = false;
+            p.type = MEDIA_AUDIO;
+        } else {
+            p.keyframe = (video_frame % 60 == 0);
+            p.size = p.keyframe ? 80000 + rand() % 40000 : 4000 + rand() % 16000;
+            p.timestamp = video_frame++ * 1000 / 30;
+            p.type = MEDIA_VIDEO;
+        }
+        packets.push_back(p);
+    }
+    return packets;
+}
+
+// 负载前 8 字节放入队时刻，消费者据此算延迟
+static void stamp(uint8_t* buf) {
+    int64_t t = now_ns();
+    memcpy(buf, &t, sizeof(t));
+}
+
+static void finish_latency(vector<int64_t>& lat, BenchResult& r) {
+    r.received = lat.size();
+    if (lat.empty()) return;
+    sort(lat.begin(), lat.end());
+    double sum = 0;
+    for (int64_t v : lat) sum += v;
+    r.lat_avg_us = sum / lat.size() / 1000.0;
+    r.lat_p50_us = lat[lat.size() / 2] / 1000.0;
+    r.lat_p99_us = lat[lat.size() * 99 / 100] / 1000.0;
+    r.lat_max_us = lat.back() / 1000.0;
+}
+
+static void pace(int interval_us, int64_t start_ns, size_t i) {
+    if (interval_us <= 0) return;
+    int64_t due = start_ns + (int64_t)i * interval_us * 1000;
+    while (now_ns() < due) this_thread::yield();
+}
+
+static BenchResult bench_mutex_queue(const vector<BenchPacket>& packets, int interval_us) {
+    // 和推流队列一样：老的 MediaPacketQueue，每个包 malloc + 拷贝一次
+    MediaPacketQueue queue(QUEUE_PACKETS, "BenchQueue");   // 默认丢最老的包
+    vector<uint8_t> src(128 * 1024, 0x5A);
+    vector<int64_t> lat;
+    lat.reserve(packets.size());
+
+    thread consumer([&] {
+        MediaPacket pkt;
+        while (queue.pop(pkt)) {
+            int64_t t;
+            memcpy(&t, pkt.data(), sizeof(t));
+            lat.push_back(now_ns() - t);
+        }
+    });
+
+    BenchResult r;
+    int64_t start = now_ns();
+    for (size_t i = 0; i < packets.size(); ++i) {
+        pace(interval_us, start, i);
+        const BenchPacket& p = packets[i];
+        stamp(src.data());
+        queue.push(make_media_packet(src.data(), p.size, p.timestamp, p.keyframe, p.type));
+    }
+    queue.stop();
+    consumer.join();
+    r.seconds = (now_ns() - start) / 1e9;
+    finish_latency(lat, r);
+    r.dropped = packets.size() - r.received;   // 队列满了会把旧包丢掉
+    return r;
+}
+
+static BenchResult bench_spsc_ring(const vector<BenchPacket>& packets, int interval_us) {
+    SpscPacketRing ring(QUEUE_PACKETS, RING_SLAB_BYTES, "BenchRing");
+    vector<uint8_t> src(128 * 1024, 0x5A);
+    vector<int64_t> lat;
+    lat.reserve(packets.size());
+
+    thread consumer([&] {
+        MediaPacket pkt;
+        while (ring.pop(pkt)) {
+            int64_t t;
+            memcpy(&t, pkt.data(), sizeof(t));
+            lat.push_back(now_ns() - t);
+        }
+    });
+
+    BenchResult r;
+    int64_t start = now_ns();
+    for (size_t i = 0; i < packets.size(); ++i) {
+        pace(interval_us, start, i);
+        const BenchPacket& p = packets[i];
+        stamp(src.data());
+        ring.push(src.data(), p.size, p.timestamp, p.keyframe, p.type);
+    }
+    ring.stop();
+    consumer.join();
+    r.seconds = (now_ns() - start) / 1e9;
+    finish_latency(lat, r);
+    r.dropped = packets.size() - r.received;   // 满了丢的是新包
+    return r;
+}
+
+static void print_result(const char* name, size_t sent, const BenchResult& r) {
+    // 入队速率是生产者的，送达速率是消费者真正拿到的 (不限速时差值就是丢掉的)
+    printf("%-18s 入队 %10.0f 包/秒  送达 %10.0f 包/秒  收到 %8llu  丢弃 %7llu  "
+           "延迟 us: 平均 %8.1f  p50 %8.1f  p99 %8.1f  最大 %9.1f\n",
+           name, sent / r.seconds, r.received / r.seconds,
+           (unsigned long long)r.received, (unsigned long long)r.dropped,
+           r.lat_avg_us, r.lat_p50_us, r.lat_p99_us, r.lat_max_us);
+}
+
+int main(int argc, char** argv) {
+    size_t count = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 200000;
+    int interval_us = (argc > 2) ? atoi(argv[2]) : 0;
+    if (count == 0) count = 1;
+
+    vector<BenchPacket> packets = make_packets(count);
+    size_t total_bytes = 0;
+    for (const BenchPacket& p : packets) total_bytes += p.size;
+    printf(">>[Bench] %zu 个包 (平均 %zu 字节)，队列深度 %zu，生产间隔 %d us\n",
+           count, total_bytes / count, QUEUE_PACKETS, interval_us);
+
+    print_result("MediaPacketQueue", count, bench_mutex_queue(packets, interval_us));
+    print_result("SpscPacketRing", count, bench_spsc_ring(packets, interval_us));
+    return 0;
+}
@@ -2,7 +2,9 @@
 #include <string>   
 #include <thread>   
 #include <atomic>   
+#include <mutex>
 #include <vector>
+#include <memory>
 #include <iostream>
 #include <unistd.h>
 #include <fcntl.h>
@@ -12,6 +14,7 @@
 #include <cstring>
 #include <csignal>
 #include <sys/stat.h>
+#include <cerrno>
 #include <ctime>
 #include <fstream>
 #include <iomanip>
@@ -20,6 +23,20 @@
 #include "video/v4l2.h"
 #include "video/rga.h"
 #include "video/mpp_encoder.h"
+#include "video/dma_buf.h"
+#include "video/dma_heap.h"
+#include "video/frame_pyramid.h"
+#include "video/cpu_convert.h"
+#include "osd/nv12_overlay.h"
+#include "osd/text_patch.h"
+#include "osd/osd_compositor.h"
+#include "video/frame_source.h"
+#include "video/v4l2_source.h"
+#include "video/file_source.h"
+#include "video/synthetic_source.h"
+#include "video/mpp_jpeg_decoder.h"
+#include "video/turbo_jpeg_decoder.h"
+#include "video/h264_nal.h"
 #include "safe_queue.h"
 #include "network/srt_pusher.h"
 #include "network/ts_muxer.h"
@@ -30,6 +47,35 @@
 
 #include "config.h"
 
+// 一路摄像头的完整管线：采集 -> (AI/水印) -> 编码 -> 推流/录像
+// 每路有自己的设备、编码器、队列和线程，多路之间只共享音频和 AI 模型
+struct CameraPipeline {
+    // 队列预算全部来自配置 (stream_queue_* / record_queue_*)
+    CameraPipeline(int id, const AppConfig& config);
+
+    int id;                       // 0 是主摄像头
+    std::string dev_name;
+    std::string stream_id;        // SRT 流 ID (第 N 路加后缀 _camN)
+    std::string record_dir;       // 录像目录 (第 N 路放到 camN 子目录)
+
+    MppEncoder    encoder;
+    FrameSource*  source = nullptr; // 视频源 (摄像头/文件回放/合成图)，要在 encoder 之前释放
+    bool zero_copy  = false;      // 摄像头直接写进编码器输入池 (DMABUF 模式)
+    bool passthrough = false;     // 摄像头直接出 H.264，不用编码器
+
+    MediaPacketQueue stream_queue; // 音视频包缓存队列
+    MediaPacketQueue record_queue; // 录像专用队列
+
+    std::thread* video_thread  = nullptr;
+    std::thread* net_thread    = nullptr;
+    std::thread* record_thread = nullptr;
+
+    // 专用内存 (从 DmaHeapPool 借，避免循环内 malloc)，每路一份，多路并发互不干扰
+    // dma-buf 的话 RGA 按 fd 写、NPU 直接读，CPU 不碰
+    DmaHeapBuffer ai_buf;     // 给 AI 用的 (640x640 RGB)
+    DmaHeapBuffer preview_buf; // 低分辨率预览 (NV12，preview_width 为 0 时不分配)
+};
+
 class StreamerApp {
 public:
     StreamerApp();
@@ -40,19 +86,32 @@ public:
     void start();
     // 停止
     void stop();
-    // 主循环 (阻塞)
+    // 主循环 (阻塞，每路摄像头一个视频线程，全部退出后返回)
     void runMainLoop();
     // 发出停止信号 (非阻塞)
     void signalStop() { m_is_running = false; }
 private:
+    // 初始化一路摄像头：打开视频源、编码器、缓冲区、采集线程
+    bool initPipeline(CameraPipeline* p);
+    // 按配置创建视频源
+    FrameSource* createFrameSource(const std::string& dev_name);
+    JpegDecoder* createJpegDecoder();
+    // 视频线程函数 (采集 -> 编码 -> 入队)
+    void videoWorker(CameraPipeline* p);
+    // H.264 直通线程函数 (采集 -> 找关键帧 -> 入队)
+    void passthroughWorker(CameraPipeline* p);
     // 网络推流线程函数
-    void networkWorker();
-    // 音频采集线程函数
+    void networkWorker(CameraPipeline* p);
+    // 音频采集线程函数 (所有摄像头共用一路音频)
     void audioWorker();
     //本地录像线程函数
-    void recordWorker();
+    void recordWorker(CameraPipeline* p);
     //生成录像文件名
-    std::string generateFileName();
+    std::string generateFileName(const std::string& record_dir);
+    // 打印队列统计 (深度/等待时间/丢帧)
+    void printQueueStats(const char* name, const QueueStats& st);
+    // 尝试 DMABUF 零拷贝采集 (条件不满足返回 false，退回 MMAP)
+    bool setupZeroCopyCapture(CameraPipeline* p, V4L2Device& camera);
     // 统一资源释放 (被 stop 和 析构函数调用)
     void releaseResources();
 private:
@@ -60,29 +119,16 @@ private:
     AppConfig m_config;
     std::atomic<bool> m_is_running;   // 全局运行开关
 
-    // --- 2. 核心数据结构 ---
-    MediaPacketQueue m_queue;         // 音视频包缓存队列
-    MediaPacketQueue m_record_queue;   // 录像专用队列
-    // --- 3. 硬件/算法对象指针 ---
-    // 使用指针是为了控制初始化时机 (init 时才 new)
-    MppEncoder* m_encoder  = nullptr;
-    YoloDetector* m_detector = nullptr;
+    // --- 2. 摄像头管线 (第 0 路是 dev_name，后面是 extra_dev_names) ---
+    // 中间帧内存池要比管线活得久 (管线释放时把内存还回来)
+    DmaHeapPool m_buffer_pool;
+    std::vector<CameraPipeline*> m_pipelines;
 
-    // --- 4. 摄像头相关 ---
-    int           m_src_width;
-    int           m_src_height;
-    int           m_src_format; // RK_FORMAT_YUYV_422 或 RK_FORMAT_YCbCr_420_SP
-    int           m_camera_fd = -1;
-    CameraBuffer* m_camera_buffers = nullptr; // V4L2 映射出的内存数组
-    int           m_n_buffers = 4;            // 缓冲区数量
+    // --- 3. 共享的算法对象 ---
+    // RKNN 上下文不能多线程同时推理，多路共用一个模型时要加锁
+    YoloDetector* m_detector = nullptr;
+    std::mutex    m_detector_mtx;
 
-    // --- 5. 线程句柄 ---
-    std::thread* m_net_thread   = nullptr;
+    // --- 4. 线程句柄 ---
     std::thread* m_audio_thread = nullptr;
-    std::thread* m_record_thread = nullptr;
-
-    // --- 6. 专用内存池 (避免循环内 malloc) ---
-    void* m_ai_buf   = nullptr; // 给 AI 用的 (640x640 RGB)
-    void* m_draw_buf = nullptr; // 给 OpenCV 画图用的 (1280x720 RGB)
-
 };
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+#include <memory>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+enum MediaType {
+    MEDIA_VIDEO,
+    MEDIA_AUDIO
+};
+
+// 引用计数的只读负载：一帧数据只分配一次，推流/录像队列共享同一份，最后一个持有者释放
+using PacketBuffer = std::shared_ptr<const uint8_t>;
+
+// 分配一块可写的负载 (生产者写完后当作 PacketBuffer 发布，之后不再修改)
+inline std::shared_ptr<uint8_t> alloc_packet_buffer(size_t size) {
+    uint8_t* p = (uint8_t*)malloc(size);
+    if (!p) return nullptr;
+    return std::shared_ptr<uint8_t>(p, free);
+}
+
+// 定义一个结构体来存 H.264 / AAC 包
+// 拷贝 MediaPacket 只增加引用计数，不复制数据
+struct MediaPacket {
+    PacketBuffer buffer;          // 共享数据块
+    size_t size = 0;              // 数据长度
+    uint32_t timestamp = 0;       // 时间戳 (ms)
+    bool is_keyframe = false;     // 是否关键帧
+    MediaType type = MEDIA_VIDEO; // 标记类型
+
+    const void* data() const { return buffer.get(); }
+};
+
+// 辅助：从一段外部内存构建数据包 (唯一的一次拷贝发生在这里)
+inline MediaPacket make_media_packet(const void* data, size_t size, uint32_t timestamp,
+                                     bool keyframe, MediaType type) {
+    MediaPacket packet;
+    std::shared_ptr<uint8_t> buf = alloc_packet_buffer(size);
+    if (buf) {
+        memcpy(buf.get(), data, size);
+        packet.buffer = buf;
+        packet.size = size;
+    }
+    packet.timestamp = timestamp;
+    packet.is_keyframe = keyframe;
+    packet.type = type;
+    return packet;
+}
@@ -17,9 +17,9 @@ public:
 
     int init(int width, int height, int fps, int sample_rate, int channels, DataCallback callback);
 
-    int write_video(void* data, int size, uint32_t timestamp, bool is_key);
+    int write_video(const void* data, int size, uint32_t timestamp, bool is_key);
 
-    int write_audio(void* data, int size, uint32_t timestamp);
+    int write_audio(const void* data, int size, uint32_t timestamp);
 
     void close();
 
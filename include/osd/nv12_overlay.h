@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 直接在 NV12 上画 OSD (检测框/标签)
+// 以前 AI 模式要 NV12 -> RGB 画完再转回 NV12，两次整帧转换只为画几个框；
+// 这里 Y 平面画亮度，UV 平面按 2x2 块写色度，只碰要画的那些像素。
+
+// 一块 NV12 图像 (Y 平面在 data，UV 平面在 data + stride * ver_stride)
+struct Nv12Image {
+    uint8_t* data;
+    int width;
+    int height;
+    int stride;       // 行跨度 (字节)，MPP 按 16 对齐
+    int ver_stride;   // Y 平面的行数 (UV 平面从这里开始)
+
+    uint8_t* y_row(int y) const { return data + (size_t)y * stride; }
+    uint8_t* uv_row(int y) const { return data + (size_t)stride * ver_stride + (size_t)(y / 2) * stride; }
+};
+
+// YUV 颜色 (BT.601 limited range，和 MPP 编码器的默认色彩空间一致)
+struct YuvColor {
+    uint8_t y, u, v;
+    static YuvColor from_rgb(int r, int g, int b);
+};
+
+// 一个字符的灰度蒙版 (0~255 = 覆盖程度)，指向图集里的一块
+struct Glyph {
+    const uint8_t* mask = nullptr;
+    int stride = 0;    // 蒙版的行跨度 (= 图集宽度)
+    int width = 0;     // 蒙版宽度
+    int height = 0;
+    int advance = 0;   // 排版时的步进 (笔画有粗细，蒙版比步进宽一点)
+    int left = 0;      // 笔触原点在蒙版里的列号 (笔画会往左伸出半个线宽)
+    int baseline = 0;  // 基线在蒙版里的行号 (从上往下数)
+};
+
+// 字形图集：构造时用 cv::putText 把可打印 ASCII 一次性光栅化，横排进一张灰度图，
+// 之后画字只是贴蒙版，运行时不再碰 Hershey 矢量字体
+// 字体固定为 FONT_HERSHEY_SIMPLEX，字号/粗细在构造时定
+class GlyphAtlas {
+public:
+    GlyphAtlas(double font_scale, int thickness);
+
+    // 取一个字符的字形 (不可打印字符画成 '?')
+    const Glyph& get(char c) const;
+
+    // 整串文字的宽度 / 高度 (上沿到基线) / 基线以下的高度
+    int text_width(const std::string& text) const;
+    int ascent() const { return ascent_; }
+    int descent() const { return descent_; }
+
+private:
+    int thickness_;
+    int ascent_ = 0;
+    int descent_ = 0;
+    std::vector<uint8_t> atlas_;  // 所有字形横排在一起，高度相同
+    Glyph glyphs_[95];            // ' ' ~ '~'
+};
+
+class Nv12Overlay {
+public:
+    explicit Nv12Overlay(double font_scale = 0.6, int thickness = 2);
+
+    /**
+     * @brief 画空心矩形 (超出图像的部分自动裁掉)
+     * @param thickness 线宽 (像素)，为了 UV 对齐会按偶数处理
+     */
+    void draw_rect(const Nv12Image& img, int x, int y, int w, int h,
+                   const YuvColor& color, int thickness = 2);
+
+    // 画实心矩形
+    void fill_rect(const Nv12Image& img, int x, int y, int w, int h, const YuvColor& color);
+
+    /**
+     * @brief 画一行文字
+     * @param x 左边
+     * @param baseline 基线所在的行 (和 cv::putText 的 org.y 一样)
+     */
+    void draw_text(const Nv12Image& img, int x, int baseline,
+                   const std::string& text, const YuvColor& color);
+
+    const GlyphAtlas& glyphs() const { return glyphs_; }
+
+private:
+    // 贴一个字形蒙版：Y 按覆盖程度混合，UV 在覆盖过半的 2x2 块上写色度
+    void blit_glyph(const Nv12Image& img, int x, int top, const Glyph& g, const YuvColor& color);
+
+private:
+    GlyphAtlas glyphs_;
+};
@@ -0,0 +1,111 @@
+#pragma once
+#include <rockchip/rk_mpi.h>
+#include <rockchip/mpp_buffer.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "osd/nv12_overlay.h"
+
+// RGA 合成的 OSD 图层
+// 每个叠加物 (logo/时钟/检测框) 是一块小的 RGBA8888 dma-buf，内容变了才用 CPU 重画；
+// 每帧用一个 RGA job 把所有图层 alpha 混合进编码器的 NV12 输入，CPU 基本不参与。
+// blend_cpu 是同样语义的 CPU 实现，RGA 不可用时兜底，也用来对照 RGA 的输出。
+
+// 非预乘的 RGBA 颜色
+struct OsdColor {
+    uint8_t r, g, b, a;
+};
+
+class OsdLayer {
+public:
+    // 位置和尺寸 (NV12 目标上 RGA 要求偶数对齐，构造时向下取偶)
+    int x() const { return x_; }
+    int y() const { return y_; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int dma_fd() const { return dma_fd_; }
+    const uint8_t* pixels() const { return pixels_; }
+
+    void set_visible(bool visible) { visible_ = visible; }
+    // 可见并且画过东西才参与合成 (全透明的图层不浪费 RGA 带宽)
+    bool active() const { return visible_ && !drawn_.empty(); }
+
+    // CPU 画图前后调用 (dma-buf 缓存同步)；begin 和 end 之间可以调用下面的画图函数
+    void begin_draw();
+    void end_draw();
+
+    // 清掉上次画过的区域 (只清画过的矩形，不整块 memset)
+    void clear();
+    void fill_rect(int x, int y, int w, int h, const OsdColor& color);
+    void draw_rect(int x, int y, int w, int h, const OsdColor& color, int thickness);
+    void draw_text(const GlyphAtlas& atlas, int x, int baseline, const std::string& text,
+                   const OsdColor& color);
+
+private:
+    friend class OsdCompositor;
+    OsdLayer() {}
+
+    struct Rect { int x0, y0, x1, y1; };
+
+    // 把一个矩形裁到图层内，并记下来等 clear 时清掉
+    bool clip_and_track(int* x0, int* y0, int* x1, int* y1);
+    // 要混合的区域：画过的矩形扩到偶数、去掉重叠 (同一个像素只能混合一次)，图层坐标
+    // 矩形太多时退化成一个外接矩形，免得一帧的 RGA 任务数失控
+    void blend_regions(std::vector<Rect>* regions) const;
+
+private:
+    int x_ = 0;
+    int y_ = 0;
+    int width_ = 0;
+    int height_ = 0;
+    bool visible_ = true;
+
+    MppBuffer buffer_ = nullptr;
+    int dma_fd_ = -1;
+    uint8_t* pixels_ = nullptr;   // RGBA8888，行跨度 = width*4
+
+    std::vector<Rect> drawn_;     // 画过内容的区域
+};
+
+class OsdCompositor {
+public:
+    OsdCompositor();
+    ~OsdCompositor();
+
+    /**
+     * @brief 分配图层内存用的 DRM 内存组
+     * @param use_rga false 时每帧都走 CPU 混合 (调试/对照用)
+     * @return 0 成功, -1 失败
+     */
+    int init(bool use_rga);
+
+    /**
+     * @brief 新建一个图层 (初始全透明)，图层归 OsdCompositor 所有
+     * @return 图层，失败返回 nullptr
+     */
+    OsdLayer* add_layer(int x, int y, int width, int height);
+
+    /**
+     * @brief 把所有活动图层按添加顺序混合进 NV12 帧
+     * RGA 模式下所有图层放进同一个 job 一次提交；RGA 失败时自动退回 CPU
+     * @param dst_fd NV12 帧的 dma-buf fd (RGA 用)
+     * @param dst 同一帧的 CPU 映射 (CPU 混合用，可以为 nullptr)
+     * @return 0 成功, -1 失败
+     */
+    int compose(int dst_fd, const Nv12Image& dst);
+
+    // CPU 参考实现：一个图层 src-over 混合到 NV12 (BT.601 limited range)
+    static void blend_cpu(const OsdLayer& layer, const Nv12Image& dst);
+
+private:
+    int compose_rga(int dst_fd, const Nv12Image& dst);
+    // 图层的一块区域 (图层坐标，偶数对齐) 混合到 NV12
+    static void blend_cpu_region(const OsdLayer& layer, const OsdLayer::Rect& r, const Nv12Image& dst);
+
+private:
+    bool use_rga_ = true;
+    bool rga_failed_ = false;
+    MppBufferGroup group_ = nullptr;
+    std::vector<OsdLayer*> layers_;
+    std::vector<OsdLayer::Rect> regions_;   // compose 时复用，避免每帧分配
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "osd/nv12_overlay.h"
+
+// 文字块里的一段：从第 x 列开始排
+struct TextSpan {
+    int x;
+    std::string text;
+    bool operator==(const TextSpan& o) const { return x == o.x && text == o.text; }
+};
+
+// 带不透明底色的文字块 (时间戳水印这种)，只画在 Y 平面上
+// 文字变了 (一秒一次) 才用图集重新合成一遍；没变的时候直接按行 memcpy 到帧上，
+// 每帧的开销就是拷贝 width*height 个字节
+class TextPatch {
+public:
+    /**
+     * @param atlas 字形图集 (生命周期要比 TextPatch 长)
+     * @param width/height 文字块大小 (底色范围)
+     * @param bg_y/fg_y 底色和文字的亮度
+     */
+    TextPatch(const GlyphAtlas& atlas, int width, int height, uint8_t bg_y, uint8_t fg_y);
+
+    /**
+     * @brief 设置文字，和上次一样就什么都不做
+     * @param spans 各段文字 (基线都放在 baseline 行)
+     * @return true 重新合成了
+     */
+    bool update(const std::vector<TextSpan>& spans, int baseline);
+
+    // 贴到帧的 (x, y) 处，超出图像的部分裁掉
+    void blit(const Nv12Image& img, int x, int y) const;
+
+private:
+    const GlyphAtlas& atlas_;
+    int width_;
+    int height_;
+    uint8_t bg_y_;
+    uint8_t fg_y_;
+
+    std::vector<TextSpan> spans_;
+    int baseline_ = -1;
+    std::vector<uint8_t> luma_;   // 合成好的亮度块 width*height
+};
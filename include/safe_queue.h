@@ -1,85 +1,209 @@
 #pragma once
-#include <queue>
+#include <deque>
 #include <mutex>
 #include <condition_variable>
+#include <algorithm>
+#include <atomic>
+#include <array>
 #include <cstring>
 #include <cstdlib>
 #include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "media_packet.h"
 
+// 视频通道满时的丢帧策略 (音频通道永远是丢最老的一个)
+enum QueueDropPolicy {
+    DROP_HEAD, // 丢最老的一个包
+    DROP_GOP   // 丢队头整组 GOP
+};
 
-enum MediaType {
-    MEDIA_VIDEO,
-    MEDIA_AUDIO
+// 队列预算：任意一项超出就开始丢帧，0 表示不限制
+struct QueueLimits {
+    size_t max_packets = 0;       // 最多缓存多少个包
+    size_t max_bytes = 0;         // 最多缓存多少字节 (决定板子上的内存上限)
+    uint32_t max_duration_ms = 0; // 队头到队尾最多跨越多少毫秒 (决定直播的延迟上限)
 };
 
-// 定义一个结构体来存 H.264 包
-struct MediaPacket {
-    void* data;         // 数据指针
-    size_t size;        // 数据长度
-    uint32_t timestamp; // 时间戳
-    bool is_keyframe;   // 是否关键帧
-    MediaType type;      // 标记类型
+// 入队到出队等待时间的直方图分桶上限 (ms)，最后一个桶是 ">= 1000ms"
+constexpr std::array<uint32_t, 8> QUEUE_LATENCY_BUCKETS_MS = {5, 10, 20, 50, 100, 200, 500, 1000};
+constexpr size_t QUEUE_LATENCY_BUCKET_COUNT = QUEUE_LATENCY_BUCKETS_MS.size() + 1;
+
+// 队列统计快照 (普通结构体，随便拷贝/打印)
+struct QueueStats {
+    size_t video_depth = 0;          // 当前视频包数
+    size_t audio_depth = 0;          // 当前音频包数
+    size_t depth_high_water = 0;     // 历史最大深度 (音视频合计)
+    size_t bytes_in_flight = 0;      // 当前缓存的总字节数
+    size_t bytes_high_water = 0;     // 历史最大字节数
+    uint64_t pushed = 0;             // 累计入队
+    uint64_t popped = 0;             // 累计出队
+    uint64_t dropped_video_key = 0;  // 丢弃的视频关键帧
+    uint64_t dropped_video = 0;      // 丢弃的视频非关键帧
+    uint64_t dropped_audio = 0;      // 丢弃的音频帧
+    uint64_t wait_total_us = 0;      // 出队包的等待时间总和 (算平均用)
+    uint64_t wait_max_us = 0;        // 最大等待时间
+    std::array<uint64_t, QUEUE_LATENCY_BUCKET_COUNT> wait_histogram{}; // 等待时间分布
+
+    double wait_avg_ms() const {
+        return popped ? (double)wait_total_us / popped / 1000.0 : 0.0;
+    }
+    uint64_t dropped_total() const {
+        return dropped_video_key + dropped_video + dropped_audio;
+    }
 };
 
+// 音视频分通道的包队列
+// 视频和音频各自排队、各自预算，大的视频突发不会把小的 AAC 帧挤掉；
+// 取出时按时间戳归并，消费者拿到的仍然是交织好的音视频序列。
 class MediaPacketQueue {
 public:
-    // max_size: 队列最大长度，超过就开始丢帧
-    MediaPacketQueue(int max_size, std::string name = "Queue") 
-        : max_size_(max_size), queue_name_(name) {}
+    // max_size: 每个通道的最大长度，超过就开始丢帧
+    // policy:   视频通道的丢帧策略，直播推流建议用 DROP_GOP
+    MediaPacketQueue(int max_size, std::string name = "Queue", QueueDropPolicy policy = DROP_HEAD)
+        : queue_name_(name), policy_(policy) {
+        video_.limits.max_packets = max_size;
+        audio_.limits.max_packets = max_size;
+    }
+
+    MediaPacketQueue(const QueueLimits& video_limits, const QueueLimits& audio_limits,
+                     std::string name = "Queue", QueueDropPolicy policy = DROP_HEAD)
+        : queue_name_(name), policy_(policy) {
+        video_.limits = video_limits;
+        audio_.limits = audio_limits;
+    }
+
+    // 运行前调整预算 (例如从 AppConfig 读取)
+    void set_limits(const QueueLimits& video_limits, const QueueLimits& audio_limits) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        video_.limits = video_limits;
+        audio_.limits = audio_limits;
+    }
 
     ~MediaPacketQueue() {
         clear();
     }
 
     // 【生产者调用】推入数据
-    void push(const void* data, size_t size, uint32_t timestamp, bool keyframe, MediaType type = MEDIA_VIDEO) {
+    // 只存引用：同一个 packet 可以同时推给多个队列，不再深拷贝
+    void push(const MediaPacket& packet) {
+        if (!packet.buffer) return;
         std::lock_guard<std::mutex> lock(mtx_);
+        int64_t now_us = get_monotonic_us();
 
-        // --- 丢帧策略 (Drop Head) ---
-        if (queue_.size() >= max_size_) {
-            MediaPacket& old = queue_.front();
-            if (old.data) free(old.data);
-            queue_.pop();
-            
-            //  智能日志：每隔 1000ms 最多打印一次，防止刷屏
-            long long now = get_current_ms();
-            if (now - last_log_time_ > 1000) {
-                // 如果是推流队列，这是警告；如果是录像队列，这是严重错误
-                std::cout << ">>[Warn] " << queue_name_ << " 拥堵! 自动丢弃旧帧 (当前缓存: " 
-                          << max_size_ << ")" << std::endl;
-                last_log_time_ = now;
+        if (packet.type == MEDIA_AUDIO) {
+            // 音频通道：只受自己的预算约束，超了丢最老的音频
+            bool dropped = false;
+            while (!audio_.packets.empty() && audio_.over_budget(packet)) {
+                count_drop_locked(audio_.packets.front().packet);
+                audio_.pop_front();
+                dropped = true;
             }
+            audio_.push_back(packet, now_us);
+            on_pushed_locked();
+            cv_.notify_one();
+            if (dropped) log_drop_locked(MEDIA_AUDIO);
+            return;
         }
 
-        // --- 正常入队 ---
-        MediaPacket packet;
-        packet.size = size;
-        packet.timestamp = timestamp;
-        packet.is_keyframe = keyframe;
-        packet.type = type;
-
-        // 深拷贝数据
-        packet.data = malloc(size);
-        if (packet.data) {
-            memcpy(packet.data, data, size);
-            queue_.push(packet);
-            cv_.notify_one();
+        // 前面丢过整组 GOP：下一个关键帧到来之前，P 帧解码不了，直接丢掉
+        if (!packet.is_keyframe && wait_keyframe_) {
+            count_drop_locked(packet);
+            log_drop_locked(MEDIA_VIDEO);
+            return;
+        }
+
+        // --- 丢帧策略：一直丢到新包放得下为止 (一个大关键帧可能要丢好几个包) ---
+        bool dropped = false;
+        while (!video_.packets.empty() && video_.over_budget(packet)) {
+            if (policy_ == DROP_GOP) {
+                drop_head_gop();
+            } else {
+                count_drop_locked(video_.packets.front().packet);
+                video_.pop_front(); // 引用计数归零时自动释放
+            }
+            dropped = true;
+        }
+
+        if (packet.is_keyframe) {
+            wait_keyframe_ = false;
+        } else if (wait_keyframe_) {
+            // 刚把整组 GOP 丢光，这个 P 帧也没有参考帧了
+            count_drop_locked(packet);
+            log_drop_locked(MEDIA_VIDEO);
+            return;
         }
+
+        // --- 正常入队 ---
+        video_.push_back(packet, now_us);
+        on_pushed_locked();
+        cv_.notify_one();
+        if (dropped) log_drop_locked(MEDIA_VIDEO);
     }
 
     // 【消费者调用】取出数据 (阻塞等待)
     bool pop(MediaPacket& packet) {
         std::unique_lock<std::mutex> lock(mtx_);
         // 等待数据，或者收到停止信号
-        cv_.wait(lock, [this]{ return !queue_.empty() || stop_flag_; });
+        cv_.wait(lock, [this]{ return !empty_locked() || stop_flag_; });
+
+        if (stop_flag_ && empty_locked()) return false;
+
+        pop_merged_locked(packet);
+        return true;
+    }
 
-        if (stop_flag_ && queue_.empty()) return false;
+    // 【消费者调用】取出数据，最多等待 timeout
+    // 返回 false 表示超时或者已停止
+    bool pop_for(MediaPacket& packet, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (!cv_.wait_for(lock, timeout, [this]{ return !empty_locked() || stop_flag_; })) {
+            return false;
+        }
+        if (empty_locked()) return false;
 
-        packet = queue_.front();
-        queue_.pop();
+        pop_merged_locked(packet);
         return true;
     }
 
+    // 【消费者调用】一次加锁取走当前所有数据 (最多 max_n 个)，队列为空时最多等待 timeout
+    // 结果按时间戳归并后覆盖写入 out，返回取到的数量 (0 表示超时或者已停止)
+    size_t pop_batch(std::vector<MediaPacket>& out, size_t max_n, std::chrono::milliseconds timeout) {
+        out.clear();
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (!cv_.wait_for(lock, timeout, [this]{ return !empty_locked() || stop_flag_; })) {
+            return 0;
+        }
+
+        while (out.size() < max_n && !empty_locked()) {
+            out.emplace_back();
+            pop_merged_locked(out.back());
+        }
+        return out.size();
+    }
+
+    // 统计快照：只读原子计数器，不加锁，监控线程随时可以调用
+    QueueStats stats() const {
+        QueueStats st;
+        st.video_depth       = stats_.video_depth.load(std::memory_order_relaxed);
+        st.audio_depth       = stats_.audio_depth.load(std::memory_order_relaxed);
+        st.depth_high_water  = stats_.depth_high_water.load(std::memory_order_relaxed);
+        st.bytes_in_flight   = stats_.bytes_in_flight.load(std::memory_order_relaxed);
+        st.bytes_high_water  = stats_.bytes_high_water.load(std::memory_order_relaxed);
+        st.pushed            = stats_.pushed.load(std::memory_order_relaxed);
+        st.popped            = stats_.popped.load(std::memory_order_relaxed);
+        st.dropped_video_key = stats_.dropped_video_key.load(std::memory_order_relaxed);
+        st.dropped_video     = stats_.dropped_video.load(std::memory_order_relaxed);
+        st.dropped_audio     = stats_.dropped_audio.load(std::memory_order_relaxed);
+        st.wait_total_us     = stats_.wait_total_us.load(std::memory_order_relaxed);
+        st.wait_max_us       = stats_.wait_max_us.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < QUEUE_LATENCY_BUCKET_COUNT; ++i) {
+            st.wait_histogram[i] = stats_.wait_histogram[i].load(std::memory_order_relaxed);
+        }
+        return st;
+    }
+
     void stop() {
         std::lock_guard<std::mutex> lock(mtx_);
         stop_flag_ = true;
@@ -88,25 +212,182 @@ public:
     //给外部清空队列用（例如断开重连时）
     void clear() {
         std::lock_guard<std::mutex> lock(mtx_);
-        while (!queue_.empty()) {
-            MediaPacket p = queue_.front();
-            if (p.data) free(p.data);
-            queue_.pop();
-        }
+        video_.clear();
+        audio_.clear();
+        update_depth_locked();
+        // 清空后第一个视频包必须是关键帧
+        if (policy_ == DROP_GOP) wait_keyframe_ = true;
     }
 private:
+    // 队列里的一项：数据包 + 入队时间 (统计等待时间用)
+    struct Entry {
+        MediaPacket packet;
+        int64_t enqueue_us;
+    };
+
+    // 一个媒体通道：独立的 FIFO 和预算
+    struct Lane {
+        std::deque<Entry> packets;
+        QueueLimits limits;
+        size_t bytes = 0; // 当前缓存的总字节数
+
+        // 把新包放进来之后是否会超出预算
+        bool over_budget(const MediaPacket& incoming) const {
+            if (limits.max_packets > 0 && packets.size() + 1 > limits.max_packets) return true;
+            if (limits.max_bytes > 0 && bytes + incoming.size > limits.max_bytes) return true;
+            if (limits.max_duration_ms > 0 && !packets.empty()) {
+                int32_t span = (int32_t)(incoming.timestamp - packets.front().packet.timestamp);
+                if (span > (int32_t)limits.max_duration_ms) return true;
+            }
+            return false;
+        }
+        void push_back(const MediaPacket& p, int64_t now_us) {
+            packets.push_back(Entry{p, now_us});
+            bytes += p.size;
+        }
+        void pop_front() {
+            bytes -= packets.front().packet.size;
+            packets.pop_front();
+        }
+        void clear() {
+            packets.clear();
+            bytes = 0;
+        }
+    };
+
+    // 统计计数器：只在持锁时写，读的时候不用锁
+    struct StatsCounters {
+        std::atomic<size_t> video_depth{0};
+        std::atomic<size_t> audio_depth{0};
+        std::atomic<size_t> depth_high_water{0};
+        std::atomic<size_t> bytes_in_flight{0};
+        std::atomic<size_t> bytes_high_water{0};
+        std::atomic<uint64_t> pushed{0};
+        std::atomic<uint64_t> popped{0};
+        std::atomic<uint64_t> dropped_video_key{0};
+        std::atomic<uint64_t> dropped_video{0};
+        std::atomic<uint64_t> dropped_audio{0};
+        std::atomic<uint64_t> wait_total_us{0};
+        std::atomic<uint64_t> wait_max_us{0};
+        std::array<std::atomic<uint64_t>, QUEUE_LATENCY_BUCKET_COUNT> wait_histogram{};
+    };
+
+    bool empty_locked() const {
+        return video_.packets.empty() && audio_.packets.empty();
+    }
+
+    // 两个通道都有数据时取时间戳更早的那个，保证输出是交织好的
+    void pop_merged_locked(MediaPacket& packet) {
+        Lane* lane;
+        if (video_.packets.empty())      lane = &audio_;
+        else if (audio_.packets.empty()) lane = &video_;
+        else {
+            // 用有符号差值比较，兼容 32 位时间戳回绕
+            int32_t diff = (int32_t)(audio_.packets.front().packet.timestamp -
+                                     video_.packets.front().packet.timestamp);
+            lane = (diff < 0) ? &audio_ : &video_;
+        }
+        int64_t enqueue_us = lane->packets.front().enqueue_us;
+        packet = std::move(lane->packets.front().packet);
+        lane->bytes -= packet.size;
+        lane->packets.pop_front();
+        on_popped_locked(get_monotonic_us() - enqueue_us);
+    }
+
+    // 丢掉视频通道队头的一整组 GOP：从队头开始，到下一个关键帧为止 (不含)
+    void drop_head_gop() {
+        std::deque<Entry>& q = video_.packets;
+        auto next_key = std::find_if(q.begin() + 1, q.end(),
+            [](const Entry& e) { return e.packet.is_keyframe; });
+
+        // 队列里只剩一组 GOP：整组丢掉，等下一个关键帧
+        if (next_key == q.end()) wait_keyframe_ = true;
+
+        for (auto it = q.begin(); it != next_key; ++it) {
+            video_.bytes -= it->packet.size;
+            count_drop_locked(it->packet);
+        }
+        q.erase(q.begin(), next_key);
+    }
+
+    // --- 统计 ---
+    void update_depth_locked() {
+        size_t depth = video_.packets.size() + audio_.packets.size();
+        size_t bytes = video_.bytes + audio_.bytes;
+        stats_.video_depth.store(video_.packets.size(), std::memory_order_relaxed);
+        stats_.audio_depth.store(audio_.packets.size(), std::memory_order_relaxed);
+        stats_.bytes_in_flight.store(bytes, std::memory_order_relaxed);
+        if (depth > stats_.depth_high_water.load(std::memory_order_relaxed)) {
+            stats_.depth_high_water.store(depth, std::memory_order_relaxed);
+        }
+        if (bytes > stats_.bytes_high_water.load(std::memory_order_relaxed)) {
+            stats_.bytes_high_water.store(bytes, std::memory_order_relaxed);
+        }
+    }
+
+    void on_pushed_locked() {
+        stats_.pushed.fetch_add(1, std::memory_order_relaxed);
+        update_depth_locked();
+    }
+
+    void on_popped_locked(int64_t wait_us) {
+        if (wait_us < 0) wait_us = 0;
+        stats_.popped.fetch_add(1, std::memory_order_relaxed);
+        stats_.wait_total_us.fetch_add(wait_us, std::memory_order_relaxed);
+        if ((uint64_t)wait_us > stats_.wait_max_us.load(std::memory_order_relaxed)) {
+            stats_.wait_max_us.store(wait_us, std::memory_order_relaxed);
+        }
+        size_t bucket = 0;
+        while (bucket < QUEUE_LATENCY_BUCKETS_MS.size() &&
+               wait_us >= (int64_t)QUEUE_LATENCY_BUCKETS_MS[bucket] * 1000) {
+            bucket++;
+        }
+        stats_.wait_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+        update_depth_locked();
+    }
+
+    void count_drop_locked(const MediaPacket& p) {
+        if (p.type == MEDIA_AUDIO)  stats_.dropped_audio.fetch_add(1, std::memory_order_relaxed);
+        else if (p.is_keyframe)     stats_.dropped_video_key.fetch_add(1, std::memory_order_relaxed);
+        else                        stats_.dropped_video.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void log_drop_locked(MediaType type) {
+        update_depth_locked();
+        //  智能日志：每隔 1000ms 最多打印一次，防止刷屏
+        long long now = get_current_ms();
+        if (now - last_log_time_ > 1000) {
+            // 如果是推流队列，这是警告；如果是录像队列，这是严重错误
+            std::cout << ">>[Warn] " << queue_name_ << " 拥堵! 自动丢弃旧"
+                      << (type == MEDIA_AUDIO ? "音频" : "视频") << "帧 (视频缓存: "
+                      << video_.packets.size() << "包/" << video_.bytes / 1024 << "KB, 音频缓存: "
+                      << audio_.packets.size() << "包, 累计丢弃: " << stats().dropped_total() << ")" << std::endl;
+            last_log_time_ = now;
+        }
+    }
+
     // 辅助：获取毫秒时间戳
     long long get_current_ms() {
         return std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::system_clock::now().time_since_epoch()).count();
     }
+
+    // 辅助：单调时钟微秒 (算等待时间，不受 NTP 调时影响)
+    static int64_t get_monotonic_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
 private:
-    std::queue<MediaPacket> queue_;
+    Lane video_;                // 视频通道
+    Lane audio_;                // 音频通道
     std::mutex mtx_;
     std::condition_variable cv_;
-    size_t max_size_;
     bool stop_flag_ = false;
 
     std::string queue_name_;    // 队列名字
     long long last_log_time_ = 0; // 上次打印警告的时间
-};
\ No newline at end of file
+
+    QueueDropPolicy policy_;
+    bool wait_keyframe_ = false;  // 丢过整组 GOP 后，等待下一个关键帧
+    StatsCounters stats_;         // 统计计数器
+};
@@ -0,0 +1,243 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include "media_packet.h"
+
+// 缓存行大小 (RK3576 的 A72/A53 都是 64 字节)
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// 单生产者/单消费者 无锁环形队列
+// 和 MediaPacketQueue 相同的 push/pop/stop/clear 约定，但：
+//   1. 负载存放在构造时一次性分配的字节 slab 里，热路径没有 malloc/free
+//   2. head/tail 是分开缓存行的原子变量，热路径没有锁和系统调用
+//   3. 满了丢弃的是“新来的包” (生产者不能动消费者那一端)；
+//      丢了视频包之后，下一个关键帧之前的视频 P 帧也一起丢 (参考帧没了，发出去也是花屏)
+//   4. pop 出来的包和 MediaPacketQueue 一样是引用计数的，可以留着、转给别的队列；
+//      还有人引用的槽位不会被覆盖 (代价是长期占着的话 ring 会变满、开始丢新包)
+// 注意：只能有一个线程 push，一个线程 pop。
+// 音视频两个生产者需要各用一个 ring。
+class SpscPacketRing {
+public:
+    // slot_count: 最多缓存多少个包 (向上取 2 的幂)
+    // slab_bytes: 负载总字节数上限
+    SpscPacketRing(size_t slot_count, size_t slab_bytes, std::string name = "Ring")
+        : slab_size_(align_up(slab_bytes)), ring_name_(name) {
+        slot_count_ = 1;
+        while (slot_count_ < slot_count) slot_count_ <<= 1;
+        slot_mask_ = slot_count_ - 1;
+        slots_.reset(new Slot[slot_count_]);
+        // 每个槽位一个引用计数，pop 出去的包借用它 (别名构造，热路径不分配)
+        for (size_t i = 0; i < slot_count_; ++i) slots_[i].owner = std::make_shared<const uint8_t>(0);
+        slab_.reset(new uint8_t[slab_size_ + CACHE_LINE_SIZE]);
+        // 手动对齐到缓存行，方便 DMA/memcpy
+        uintptr_t base = (uintptr_t)slab_.get();
+        slab_base_ = (uint8_t*)((base + CACHE_LINE_SIZE - 1) & ~(uintptr_t)(CACHE_LINE_SIZE - 1));
+    }
+
+    SpscPacketRing(const SpscPacketRing&) = delete;
+    SpscPacketRing& operator=(const SpscPacketRing&) = delete;
+
+    // 【生产者调用】拷贝到 slab 里 (唯一一次拷贝)
+    // 返回 false 表示队列满或包太大，这个包被丢弃
+    bool push(const void* data, size_t size, uint32_t timestamp, bool keyframe, MediaType type = MEDIA_VIDEO) {
+        // 前面丢过视频包：等到下一个关键帧再收视频
+        if (type == MEDIA_VIDEO && wait_keyframe_ && !keyframe) {
+            on_drop();
+            return false;
+        }
+        if (!data || size == 0 || size > slab_size_) {
+            drop_new(type);
+            return false;
+        }
+
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        uint64_t tail = cached_tail_;
+        uint64_t byte_tail = cached_byte_tail_;
+
+        // 负载在 slab 里必须连续，尾部放不下就跳到开头 (浪费掉尾部那一段)
+        uint64_t start = write_pos_;
+        size_t offset = start % slab_size_;
+        if (offset + size > slab_size_) start += slab_size_ - offset;
+        uint64_t end = align_up(start + size);
+
+        if (!has_room(head, tail, byte_tail, end)) {
+            // 一直满的时候不要每次都去读消费者的缓存行：刷新失败后按指数退避，
+            // 接下来几次直接丢，不碰 tail_
+            if (refresh_skip_ > 0) {
+                refresh_skip_--;
+                drop_new(type);
+                return false;
+            }
+            // 本地缓存的 tail 可能过时，重新读一次消费者位置
+            tail = tail_.load(std::memory_order_acquire);
+            byte_tail = byte_tail_.load(std::memory_order_acquire);
+            cached_tail_ = tail;
+            cached_byte_tail_ = byte_tail;
+            if (!has_room(head, tail, byte_tail, end)) {
+                refresh_backoff_ = refresh_backoff_ ? std::min<uint32_t>(refresh_backoff_ * 2, MAX_REFRESH_BACKOFF) : 1;
+                refresh_skip_ = refresh_backoff_;
+                drop_new(type);
+                return false;
+            }
+        }
+        refresh_backoff_ = 0;
+
+        Slot& slot = slots_[head & slot_mask_];
+        slot.offset = start % slab_size_;
+        slot.end = end;
+        slot.size = size;
+        slot.timestamp = timestamp;
+        slot.is_keyframe = keyframe;
+        slot.type = type;
+        memcpy(slab_base_ + slot.offset, data, size);
+
+        write_pos_ = end;
+        head_.store(head + 1, std::memory_order_release);
+        if (type == MEDIA_VIDEO && keyframe) wait_keyframe_ = false;
+        return true;
+    }
+
+    bool push(const MediaPacket& packet) {
+        return push(packet.data(), packet.size, packet.timestamp, packet.is_keyframe, packet.type);
+    }
+
+    // 【消费者调用】取出数据 (阻塞等待)
+    // 取出的 packet 直接指向 slab，不拷贝，引用计数挂在槽位上：
+    // 最后一个引用释放之后，消费者下一次 pop/clear 时才把槽位还给生产者。
+    bool pop(MediaPacket& packet) {
+        packet.buffer.reset();   // 上一个包如果没人再用，这次就能回收
+        reclaim();
+
+        uint64_t read = read_.load(std::memory_order_relaxed);
+        int idle = 0;
+        while (head_.load(std::memory_order_acquire) == read) {
+            if (stop_flag_.load(std::memory_order_acquire)) return false;
+            // 先自旋，再让出 CPU，长时间空闲才真正睡眠 (非热路径)
+            if (idle < 64)        { cpu_relax(); }
+            else if (idle < 256)  { std::this_thread::yield(); }
+            else                  { std::this_thread::sleep_for(std::chrono::microseconds(200)); reclaim(); }
+            idle++;
+        }
+
+        const Slot& slot = slots_[read & slot_mask_];
+        // 别名构造：共享槽位的引用计数，不分配控制块，指针指向 slab
+        packet.buffer = PacketBuffer(slot.owner, slab_base_ + slot.offset);
+        packet.size = slot.size;
+        packet.timestamp = slot.timestamp;
+        packet.is_keyframe = slot.is_keyframe;
+        packet.type = slot.type;
+        read_.store(read + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void stop() {
+        stop_flag_.store(true, std::memory_order_release);
+    }
+
+    // 【消费者调用】丢弃所有未读数据 (或者在两端线程都退出之后调用)
+    // 已经 pop 出去、还有人引用的包不受影响，等引用释放后再回收
+    void clear() {
+        read_.store(head_.load(std::memory_order_acquire), std::memory_order_relaxed);
+        reclaim();
+    }
+
+    // 还没被 pop 的包数
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - read_.load(std::memory_order_relaxed);
+    }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::shared_ptr<const uint8_t> owner;   // 槽位的引用计数 (构造时建好，之后不变)
+        size_t offset = 0;      // 负载在 slab 里的偏移
+        uint64_t end = 0;       // 这个包结束后的写位置 (单调递增)
+        size_t size = 0;
+        uint32_t timestamp = 0;
+        bool is_keyframe = false;
+        MediaType type = MEDIA_VIDEO;
+    };
+
+    static uint64_t align_up(uint64_t v) {
+        return (v + CACHE_LINE_SIZE - 1) & ~(uint64_t)(CACHE_LINE_SIZE - 1);
+    }
+
+    static void cpu_relax() {
+#if defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield" ::: "memory");
+#elif defined(__x86_64__) || defined(__i386__)
+        asm volatile("pause" ::: "memory");
+#endif
+    }
+
+    // 队列为空时整块 slab 都可用 (绕回开头时跳过的尾部不再占位)
+    bool has_room(uint64_t head, uint64_t tail, uint64_t byte_tail, uint64_t end) const {
+        if (head == tail) return true;
+        return (head - tail) < slot_count_ && (end - byte_tail) <= slab_size_;
+    }
+
+    // 把已经读过、没人再引用的槽位按顺序还给生产者 (遇到还被引用的就停)
+    void reclaim() {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        uint64_t read = read_.load(std::memory_order_relaxed);
+        uint64_t freed = tail;
+        while (freed != read && slots_[freed & slot_mask_].owner.use_count() == 1) freed++;
+        if (freed == tail) return;
+        // 和持有者释放引用时的 release 配对：它对负载的读取都发生在生产者覆盖之前
+        std::atomic_thread_fence(std::memory_order_acquire);
+        byte_tail_.store(slots_[(freed - 1) & slot_mask_].end, std::memory_order_release);
+        tail_.store(freed, std::memory_order_release);
+    }
+
+    // 生产者丢了一个新包：视频的话后面的 P 帧也没法解了，等下一个关键帧
+    void drop_new(MediaType type) {
+        if (type == MEDIA_VIDEO) wait_keyframe_ = true;
+        on_drop();
+    }
+
+    void on_drop() {
+        uint64_t n = dropped_.fetch_add(1, std::memory_order_relaxed) + 1;
+        //  智能日志：只在第 1、1024、2048... 次丢包时打印，且不持有任何锁
+        if ((n & 1023) == 1) {
+            fprintf(stderr, ">>[Warn] %s 拥堵! 丢弃新包 (累计丢弃: %llu)\n",
+                    ring_name_.c_str(), (unsigned long long)n);
+        }
+    }
+
+private:
+    // --- 生产者独占 ---
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head_{0};
+    uint64_t write_pos_ = 0;         // slab 写位置 (单调递增)
+    uint64_t cached_tail_ = 0;       // 生产者本地缓存的 tail，减少跨核读
+    uint64_t cached_byte_tail_ = 0;
+    uint32_t refresh_backoff_ = 0;   // 满了以后刷新 tail 的退避长度
+    uint32_t refresh_skip_ = 0;      // 还要跳过几次刷新
+    bool wait_keyframe_ = false;     // 丢过视频包，等下一个关键帧
+    static constexpr uint32_t MAX_REFRESH_BACKOFF = 64;
+
+    // --- 消费者独占 ---
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail_{0};
+    std::atomic<uint64_t> byte_tail_{0}; // 消费者已释放到的 slab 位置
+    std::atomic<uint64_t> read_{0};      // 下一个要 pop 的位置 (只有消费者写，size() 会读)
+
+    // --- 生产者写、监控线程读 (单独一行，不和 stop_flag_ 挤在一起) ---
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> dropped_{0};
+
+    // --- 共享/只读 ---
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> stop_flag_{false};
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t slot_count_ = 0;
+    size_t slot_mask_ = 0;
+    std::unique_ptr<uint8_t[]> slab_;
+    uint8_t* slab_base_ = nullptr;
+    size_t slab_size_ = 0;
+    std::string ring_name_;
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include "video/v4l2.h"
+
+// 独立的 V4L2 采集线程
+// 用 epoll 等待摄像头 fd (再加一个 eventfd 用来退出)，一有帧就立刻 DQBUF，
+// 下游处理再慢也不会让驱动没 buffer 可用。
+// 交接方式默认是“只保留最新一帧”：处理线程还没取走的旧帧会被自动 QBUF 还给驱动。
+// H.264 直通时一帧都不能丢 (丢了 P 帧后面全花)，用 set_max_pending 改成按顺序排队。
+//
+// 所有权：
+//   - acquire() 取到的帧归处理线程所有，采集线程不会再碰它
+//   - 处理完必须调用 release() 归还给驱动
+class CaptureThread {
+public:
+    CaptureThread();
+    ~CaptureThread();
+
+    /**
+     * @brief 启动采集线程 (摄像头必须已经 STREAMON)
+     * @param camera 摄像头设备 (O_NONBLOCK 打开)，生命周期要比采集线程长
+     * @return 0 成功, -1 失败
+     */
+    int start(V4L2Device* camera);
+
+    /**
+     * @brief 最多攒多少帧等处理线程来取，超过就把最老的还给驱动 (start 之前调用)
+     * @param count 1 = 只留最新一帧 (默认)；>1 = 按顺序排队，适合不能丢帧的码流
+     */
+    void set_max_pending(int count) { max_pending_ = (count > 0) ? count : 1; }
+
+    /**
+     * @brief 停止采集线程，并归还还没被取走的帧
+     */
+    void stop();
+
+    /**
+     * @brief 等待下一帧 (默认模式下是最新的一帧)
+     * @param info 输出帧信息 (index/时间戳/序号)
+     * @param timeout_ms 最长等待时间
+     * @return true 取到帧，false 超时或已停止
+     */
+    bool acquire(FrameInfo* info, int timeout_ms);
+
+    /**
+     * @brief 归还 acquire 取到的帧 (QBUF)
+     */
+    void release(int index);
+
+    // 因为下游来不及处理而被直接归还的帧数
+    uint64_t get_skipped() const { return skipped_.load(); }
+
+private:
+    void loop();
+    // 等下游 release() 还回一帧 (seen 是开始等之前的归还计数)，或者超时/退出
+    void wait_for_release(uint64_t seen, int timeout_ms);
+
+private:
+    V4L2Device* camera_ = nullptr;
+    int epoll_fd_ = -1;
+    int event_fd_ = -1;      // 写入它来唤醒并退出 epoll_wait
+    std::thread* thread_ = nullptr;
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<FrameInfo> pending_; // 等着被取走的帧，按出队顺序
+    size_t max_pending_ = 1;
+    bool stopped_ = false;
+    std::condition_variable release_cv_;  // release() 时通知采集线程
+    uint64_t released_ = 0;               // 下游累计归还的帧数
+    std::atomic<bool> quit_{false};
+
+    std::atomic<uint64_t> skipped_{0};
+    uint64_t dqbuf_errors_ = 0;           // 只在采集线程里用
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// CPU 颜色转换/缩放 (RGA 的后备)
+// RGA 被多路摄像头占满、或者驱动出错的时候，用 CPU 做同样的转换。
+// 这里只有裸指针接口，不依赖 librga (x86 上也能编译、跑基准)；按 RgaImage 转换的适配在 rga_cpu_fallback.h。
+// 每种转换都有标量参考实现和 SIMD 实现 (ARM: NEON；x86: SSE2/AVX2)，结果逐字节一致，
+// 每次调用可以指定用哪一套，默认 (CPU_ISA_AUTO) 选本机支持的最快的。
+// 颜色空间和 YuvColor::from_rgb、RGA 默认的一样是 BT.601 limited range，8 位定点系数 (Y=235 -> 255)。
+// 宽高都要求是偶数。
+
+enum CpuIsa {
+    CPU_ISA_AUTO = 0,
+    CPU_ISA_SCALAR,
+    CPU_ISA_NEON,
+    CPU_ISA_SSE2,
+    CPU_ISA_AVX2,
+};
+
+const char* cpu_isa_name(CpuIsa isa);
+bool cpu_isa_supported(CpuIsa isa);
+// 本机支持的最快的一套
+CpuIsa cpu_isa_best();
+
+// YUYV -> NV12，同尺寸 (UV 取上下两行的平均)
+void cpu_yuyv_to_nv12(const uint8_t* src, int src_stride, int width, int height,
+                      uint8_t* dst_y, int y_stride, uint8_t* dst_uv, int uv_stride,
+                      CpuIsa isa = CPU_ISA_AUTO);
+
+// 缩放用的采样表和行缓冲，只和源/目标尺寸有关
+// 每帧都转同样尺寸的调用者 (比如 FramePyramid 的一层) 留一个反复用，热路径上就不用再分配；
+// 尺寸变了会自动重算
+struct CpuScaleCache {
+    int src_w = 0, src_h = 0, dst_w = 0, dst_h = 0;
+    std::vector<int> ys, xs, cys, cxs;           // 采样位置 (Y 和色度各一套)
+    std::vector<uint8_t> wys, wxs, wcys, wcxs;   // 对应的 7 位权重
+    std::vector<uint8_t> vy, vuv, hy, huv;       // 竖直/横向插值后的一行
+
+    void prepare(int src_w, int src_h, int dst_w, int dst_h);
+};
+
+// NV12 -> RGB888，双线性缩放到 dst_w x dst_h (像素中心对齐，和 RGA 的缩放一致)
+// cache 为空时临时建一个 (每次调用都要分配，只适合偶尔转一次的地方)
+void cpu_nv12_to_rgb(const uint8_t* src_y, int y_stride, const uint8_t* src_uv, int uv_stride,
+                     int src_w, int src_h,
+                     uint8_t* dst, int dst_stride, int dst_w, int dst_h,
+                     CpuIsa isa = CPU_ISA_AUTO, CpuScaleCache* cache = nullptr);
+
+// RGB888 -> NV12，同尺寸 (UV 取 2x2 的平均)
+void cpu_rgb_to_nv12(const uint8_t* src, int src_stride, int width, int height,
+                     uint8_t* dst_y, int y_stride, uint8_t* dst_uv, int uv_stride,
+                     CpuIsa isa = CPU_ISA_AUTO);
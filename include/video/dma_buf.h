@@ -0,0 +1,35 @@
+#pragma once
+#include <linux/dma-buf.h>
+
+// DMA-BUF 的 CPU 访问同步
+// RGA/MPP/摄像头都是硬件直接读写内存，CPU 要在中间插一脚 (比如画水印) 的话，
+// 必须用 DMA_BUF_IOCTL_SYNC 把 CPU 访问包起来：
+//   begin -> CPU 读写 -> end
+// begin 让 CPU 看到硬件刚写的数据 (invalidate)，end 把 CPU 写的数据刷出去给下一个硬件 (flush)。
+// 映射可以一直保留，不需要每帧 mmap/munmap。
+
+// flags: DMA_BUF_SYNC_READ / DMA_BUF_SYNC_WRITE / DMA_BUF_SYNC_RW
+// 返回值：0 成功，-1 失败 (fd 无效，或者不是 dma-buf)
+int dma_buf_sync_begin(int fd, unsigned int flags = DMA_BUF_SYNC_RW);
+int dma_buf_sync_end(int fd, unsigned int flags = DMA_BUF_SYNC_RW);
+
+// 作用域内的 CPU 访问：构造时 begin，析构时 end
+class DmaBufCpuAccess {
+public:
+    explicit DmaBufCpuAccess(int fd, unsigned int flags = DMA_BUF_SYNC_RW)
+        : fd_(fd), flags_(flags) {
+        ok_ = (dma_buf_sync_begin(fd_, flags_) == 0);
+    }
+    ~DmaBufCpuAccess() {
+        if (ok_) dma_buf_sync_end(fd_, flags_);
+    }
+    DmaBufCpuAccess(const DmaBufCpuAccess&) = delete;
+    DmaBufCpuAccess& operator=(const DmaBufCpuAccess&) = delete;
+
+    bool ok() const { return ok_; }
+
+private:
+    int fd_;
+    unsigned int flags_;
+    bool ok_ = false;
+};
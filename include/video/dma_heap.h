@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 一块 CPU 可见的共享内存
+struct DmaHeapBuffer {
+    int fd = -1;            // dma-buf fd (RGA/RKNN/MPP 直接用)；memfd 兜底时为 -1，只能走虚拟地址
+    void* ptr = nullptr;    // CPU 映射
+    size_t size = 0;        // 实际大小 (按尺寸档向上取整，>= 申请的大小)
+    int backing_fd = -1;    // memfd 兜底时的文件 fd (内部用)
+};
+
+// 中间帧内存池
+// 从 /dev/dma_heap 分配物理连续/可 DMA 的内存，RGA 走 fd 而不是分散的用户页，
+// NPU 也能直接把它当输入 (零拷贝)。没有 dma_heap 的机器 (PC 上跑 file/synthetic 源)
+// 退回 memfd，接口不变，只是 fd 为 -1。
+// 释放的内存按尺寸档挂回空闲链表，下次同档的申请直接复用，不反复找内核要。
+class DmaHeapPool {
+public:
+    DmaHeapPool();
+    ~DmaHeapPool();
+
+    /**
+     * @brief 打开 dma_heap (按顺序试几个常见的 heap)，都打不开就用 memfd
+     * @return 0 成功 (包括退回 memfd)
+     */
+    int init();
+
+    /**
+     * @brief 申请一块内存 (优先复用空闲链表)，内容不清零
+     * @return 0 成功, -1 失败
+     */
+    int acquire(size_t size, DmaHeapBuffer* out);
+
+    // 还给内存池 (不真正释放，池析构时统一释放)
+    void release(DmaHeapBuffer* buf);
+
+    bool is_dma_heap() const { return heap_fd_ >= 0; }
+    const std::string& get_heap_name() const { return heap_name_; }
+
+private:
+    static size_t size_class(size_t size);
+    int alloc_heap(size_t size, DmaHeapBuffer* out);
+    int alloc_memfd(size_t size, DmaHeapBuffer* out);
+    static void free_buffer(DmaHeapBuffer* buf);
+
+private:
+    int heap_fd_ = -1;
+    std::string heap_name_;
+
+    std::mutex mtx_;
+    std::map<size_t, std::vector<DmaHeapBuffer>> free_;   // 尺寸档 -> 空闲内存
+    size_t outstanding_ = 0;                              // 借出去还没还的块数
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <atomic>
+#include "video/frame_source.h"
+
+// 原始 YUV 文件回放源 (NV12 或 YUYV，逐帧紧密排列，没有文件头)
+// 整个文件 mmap 进来，帧直接指向映射区，不拷贝；放完自动从头循环。
+// 可以用 ffmpeg 生成：ffmpeg -i in.mp4 -s 1280x720 -pix_fmt nv12 -f rawvideo out.nv12
+class FileFrameSource : public FrameSource {
+public:
+    // pixel_format: "nv12" 或 "yuyv"
+    // paced: true 按 fps 出帧，false 全速出帧 (测吞吐用)
+    FileFrameSource(const std::string& path, const std::string& pixel_format, bool paced);
+    ~FileFrameSource();
+
+    int open(int width, int height, int fps) override;
+    int start() override;
+    void stop() override;
+    bool acquire(SourceFrame* frame, int timeout_ms) override;
+    void release(int index) override {}
+    int get_format() const override { return format_; }
+    int get_width() const override { return width_; }
+    int get_height() const override { return height_; }
+    const char* get_name() const override { return path_.c_str(); }
+
+private:
+    std::string path_;
+    std::string pixel_format_;
+    bool paced_;
+    int width_ = 0;
+    int height_ = 0;
+    int fps_ = 30;
+    int format_ = 0;
+
+    int fd_ = -1;
+    void* map_ = nullptr;       // 整个文件的映射
+    size_t map_size_ = 0;
+    size_t frame_size_ = 0;
+    int frame_count_ = 0;       // 文件里有几帧
+    int next_frame_ = 0;        // 下一帧在文件里的位置
+    uint32_t sequence_ = 0;
+
+    FramePacer pacer_;
+    std::atomic<bool> running_{false};
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include "video/rga.h"
+#include "video/rga_job.h"
+#include "video/rga_cpu_fallback.h"
+
+// 帧金字塔的各层
+enum PyramidLevel {
+    PYRAMID_ENCODER = 0,   // 编码器输入 (NV12，编码分辨率)
+    PYRAMID_AI,            // 模型输入 (640x640 RGB)
+    PYRAMID_PREVIEW,       // 低分辨率预览 (NV12，给子码流/抓图用)
+    PYRAMID_LEVEL_COUNT
+};
+
+// 一帧摄像头图像派生出来的所有图
+// 每帧只读一次源：所有启用的层放进一个 RGA job 一起生成，生成完源帧就可以还给驱动，
+// 后面的推理/画框/编码都只读这里的结果。
+// 各层的内存由调用者提供 (编码器输入、DmaHeapPool 借来的 buffer)，金字塔不拥有它们。
+// RGA 忙不过来 (多路摄像头) 时可以把某一层交给 CPU (cpu_convert.h)，和 RGA 同时做；
+// RGA 出错时 CPU 支持的层也会自动退回 CPU。
+class FramePyramid {
+public:
+    FramePyramid();
+
+    // 启用某一层，输出写到 img 描述的内存里 (编码器零拷贝时每帧的输入 buffer 不同，每帧设一次)
+    void set_level(PyramidLevel level, const RgaImage& img);
+    // 同上，但只缩放到 img 的 region 里 (比如保持宽高比的 letterbox)，region 以外填 pad_color
+    // (0xAABBGGRR)。填充只在第一帧做一次，后面每帧只写 region
+    void set_level(PyramidLevel level, const RgaImage& img, const im_rect& region, uint32_t pad_color);
+    void disable_level(PyramidLevel level);
+    bool has_level(PyramidLevel level) const { return enabled_[level]; }
+    // 这一层用 CPU 转换 (源和目标都要有 ptr，格式组合 CPU 不支持的话还是走 RGA)
+    void set_cpu_level(PyramidLevel level, bool cpu) { cpu_[level] = cpu; }
+
+    /**
+     * @brief 异步提交：从源帧生成所有启用的层 (一个 RGA job)
+     * 提交后 CPU 可以先做别的，读任何一层或者还源帧之前必须 wait()
+     * @param src 源帧
+     * @param sequence 源帧序号，记下来方便消费者对帧
+     * @return 0 成功, -1 CPU 层转换失败 (RGA 层的结果看 wait())
+     */
+    int submit(const RgaImage& src, uint32_t sequence);
+    // 等 submit 的结果 (RGA 失败时 CPU 支持的层在这里补做)
+    int wait();
+
+    // 提交并等完
+    int build(const RgaImage& src, uint32_t sequence) {
+        int ret = submit(src, sequence);
+        return (wait() == 0) ? ret : -1;
+    }
+
+    // 读取某一层 (只读，下一次 build 之前有效)
+    const RgaImage& level(PyramidLevel level) const { return levels_[level]; }
+    uint32_t sequence() const { return sequence_; }
+
+private:
+    bool cpu_capable(int level, const RgaImage& src) const;
+    int convert_on_cpu(int level, const RgaImage& src);
+
+private:
+    RgaImage levels_[PYRAMID_LEVEL_COUNT];
+    bool enabled_[PYRAMID_LEVEL_COUNT];
+    bool cpu_[PYRAMID_LEVEL_COUNT];
+    bool on_rga_[PYRAMID_LEVEL_COUNT];   // 本帧交给 RGA 的层
+    bool has_region_[PYRAMID_LEVEL_COUNT];
+    im_rect regions_[PYRAMID_LEVEL_COUNT];
+    uint32_t pad_colors_[PYRAMID_LEVEL_COUNT];
+    bool pad_pending_[PYRAMID_LEVEL_COUNT];   // 填充区还没填
+    CpuScaleCache cpu_cache_[PYRAMID_LEVEL_COUNT];   // CPU 缩放的采样表/行缓冲，每层一份
+    uint32_t sequence_ = 0;
+    RgaImage src_;
+    RgaJob job_;
+    bool rga_error_logged_ = false;
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "video/v4l2.h"
+
+// 视频源取出的一帧
+struct SourceFrame {
+    int index;        // 源内部的 buffer 编号，release 时原样传回
+    int dma_fd;       // DMA-BUF fd (RGA/MPP 直接用)，没有就是 -1
+    void* virt;       // CPU 地址，没有 dma_fd 时 RGA 走虚拟地址
+    size_t size;      // 有效数据长度
+    int format;       // RGA 格式 (RK_FORMAT_xxx)，MJPEG 解码的输出可能每帧不同
+    int hor_stride;   // 行跨度 (像素)
+    int ver_stride;   // 平面高度 (行)，硬解出来的 1080p 是 1088
+    FrameInfo info;   // 时间戳/帧序号 (和 V4L2 同一个单调时钟)
+};
+
+// 视频源接口：摄像头、文件回放、合成测试图都实现这一套，
+// 下游 (RGA/AI/MPP/推流/录像) 不关心帧是从哪来的。
+//
+// 用法：open -> start -> (acquire -> 处理 -> release)* -> stop
+class FrameSource {
+public:
+    virtual ~FrameSource() {}
+
+    /**
+     * @brief 按输出分辨率/帧率打开源
+     * @return 0 成功, -1 失败
+     */
+    virtual int open(int width, int height, int fps) = 0;
+
+    /**
+     * @brief 开始出帧
+     * @return 0 成功, -1 失败
+     */
+    virtual int start() = 0;
+
+    /**
+     * @brief 停止出帧，归还所有还没被取走的帧
+     */
+    virtual void stop() = 0;
+
+    /**
+     * @brief 等待下一帧
+     * @param frame 输出帧
+     * @param timeout_ms 最长等待时间
+     * @return true 取到帧，false 超时或已停止
+     */
+    virtual bool acquire(SourceFrame* frame, int timeout_ms) = 0;
+
+    /**
+     * @brief 归还 acquire 取到的帧
+     */
+    virtual void release(int index) = 0;
+
+    // 像素格式 (RK_FORMAT_YCbCr_420_SP / RK_FORMAT_YUYV_422，MJPEG 是解码后的格式)
+    virtual int get_format() const = 0;
+    // 出帧分辨率 (摄像头协商的结果可能和编码分辨率不一样，由 RGA 缩放)
+    virtual int get_width() const = 0;
+    virtual int get_height() const = 0;
+    // 出的是 H.264 码流而不是图像 (直通模式：virt/size 是一帧 Annex-B 数据，不用 RGA/编码)
+    virtual bool is_encoded() const { return false; }
+    // 因为下游来不及处理而被跳过的帧数
+    virtual uint64_t get_skipped() const { return 0; }
+    // 日志里显示的名字
+    virtual const char* get_name() const = 0;
+};
+
+// 按帧率控制出帧节奏 (文件回放/合成源用)
+// paced = false 时不等待，全速出帧，用来测下游的极限吞吐
+class FramePacer {
+public:
+    void reset(int fps, bool paced);
+
+    /**
+     * @brief 等到下一帧该出的时刻
+     * @return true 到点了，false 等了 timeout_ms 还没到
+     */
+    bool wait(int timeout_ms);
+
+    // 单调时钟 (微秒)，和 V4L2 驱动时间戳同源
+    static int64_t now_us();
+
+private:
+    bool paced_ = true;
+    int64_t period_us_ = 33333;
+    int64_t next_us_ = 0;
+};
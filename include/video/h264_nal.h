@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// H.264 Annex-B 码流的简单解析 (只看 NAL 头，不解 slice)
+// 给 H.264 直通模式用：摄像头直接出码流，没有编码器告诉我们哪一帧是 IDR
+
+// NAL 类型 (nal_unit_type，NAL 头的低 5 位)
+enum H264NalType {
+    H264_NAL_SLICE = 1,
+    H264_NAL_IDR   = 5,
+    H264_NAL_SEI   = 6,
+    H264_NAL_SPS   = 7,
+    H264_NAL_PPS   = 8,
+    H264_NAL_AUD   = 9,
+};
+
+// 一个访问单元 (一帧) 里有哪些 NAL
+struct H264AuInfo {
+    bool has_idr = false;
+    bool has_sps = false;
+    bool has_pps = false;
+    int nal_count = 0;
+};
+
+/**
+ * @brief 扫描一帧码流里的所有 NAL
+ * @return true 至少找到一个起始码，false 不是 Annex-B 码流
+ */
+bool h264_scan_au(const uint8_t* data, size_t size, H264AuInfo* info);
+
+// 记住最近一次的 SPS/PPS
+// 有的 UVC 摄像头只在开流时发一次 SPS/PPS，之后的 IDR 不带；
+// 录像切片、SRT 新连接都要从 IDR 开始解，所以要在 IDR 前面补上
+class H264ParamSets {
+public:
+    // 从一帧里提取 SPS/PPS (有就覆盖旧的)
+    void update(const uint8_t* data, size_t size);
+    bool ready() const { return !sps_.empty() && !pps_.empty(); }
+    // 起始码 + SPS + 起始码 + PPS
+    size_t header_size() const;
+    // 把 header 写到 dst，返回写了多少字节
+    size_t write_header(uint8_t* dst) const;
+
+private:
+    std::vector<uint8_t> sps_;   // 不含起始码
+    std::vector<uint8_t> pps_;
+};
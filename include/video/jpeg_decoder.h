@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// 解码出来的一帧
+struct DecodedFrame {
+    int dma_fd;       // DMA-BUF fd (RGA/MPP 直接用)，软解没有就是 -1
+    void* virt;       // CPU 地址
+    int width;
+    int height;
+    int hor_stride;   // 行跨度 (像素)，硬解会按 16 对齐
+    int ver_stride;   // 平面高度 (行)，NV12 的 UV 平面在 hor_stride*ver_stride 之后
+    int format;       // RGA 格式 (RK_FORMAT_xxx)
+};
+
+// JPEG 解码器接口：MJPEG 摄像头每一帧都是一张完整的 JPEG
+// 输出内存由解码器自己管理，分成 slot_count 块，调用方指定解到哪一块，
+// 这样下游还拿着上一帧的时候，下一帧可以解到别的 slot 里。
+class JpegDecoder {
+public:
+    virtual ~JpegDecoder() {}
+
+    /**
+     * @brief 按图像尺寸分配输出内存
+     * @param width/height 摄像头协商出来的分辨率
+     * @param slot_count 输出内存块数
+     * @return 0 成功, -1 失败
+     */
+    virtual int init(int width, int height, int slot_count) = 0;
+
+    /**
+     * @brief 解一帧
+     * @param data/size JPEG 码流 (V4L2 的 bytesused)
+     * @param slot 解到第几块输出内存
+     * @param out 输出帧
+     * @return 0 成功, -1 失败 (坏帧，跳过即可)
+     */
+    virtual int decode(const void* data, size_t size, int slot, DecodedFrame* out) = 0;
+
+    // 输出的 RGA 格式 (init 之后有效)
+    virtual int get_format() const = 0;
+    // 日志里显示的名字
+    virtual const char* get_name() const = 0;
+};
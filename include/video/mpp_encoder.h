@@ -3,6 +3,8 @@
 #include <rockchip/mpp_buffer.h>
 #include <rockchip/mpp_meta.h>
 #include <cstdio>
+#include <vector>
+#include "media_packet.h"
 class MppEncoder {
 public:
     MppEncoder();
@@ -29,15 +31,52 @@ public:
      */
     int encode(FILE* out_fp);
 
-    int encode_to_memory(void** out_data, size_t* out_len, bool* is_key);
+    /**
+     * @brief 执行编码，结果拷贝到一块引用计数的内存里 (每帧只分配一次)
+     * @param out_data 输出数据块，可直接共享给多个队列
+     * @param out_len 数据长度
+     * @param is_key 是否 IDR 帧 (可传 nullptr)
+     * @return 0 成功, -1 失败
+     */
+    int encode_to_memory(PacketBuffer* out_data, size_t* out_len, bool* is_key);
 
+    /**
+     * @brief 输入缓冲区的 CPU 地址 (MPP 分配时已映射，整个生命周期有效)
+     * CPU 读写前后要用 dma_buf_sync_begin/end (video/dma_buf.h) 同步缓存
+     */
     void* get_input_ptr();
 
+    /**
+     * @brief 额外分配一组输入内存，给 V4L2 DMABUF 模式直接采集进来 (省掉一次 RGA 拷贝)
+     * @param count 数量 (和 V4L2 缓冲区数量一致)
+     * @param out_fds 输出每块内存的 DMA-FD，数组长度至少 count
+     * @return 0 成功, -1 失败
+     */
+    int alloc_input_pool(int count, int* out_fds);
+
+    /**
+     * @brief 直接编码输入池里的第 index 块 (摄像头刚写完的那一帧)
+     * 参数和返回值同 encode_to_memory
+     */
+    int encode_pool_to_memory(int index, PacketBuffer* out_data, size_t* out_len, bool* is_key);
+
+    int get_pool_fd(int index) const;
+    void* get_pool_ptr(int index);
+
+    // 输入内存布局 (NV12, 按 16 对齐)
+    int get_hor_stride() const;
+    int get_ver_stride() const;
+    size_t get_frame_size() const;
+
     /**
      * @brief 销毁资源
      */
     void deinit();
 
+private:
+    // 把一块输入内存送进编码器，取回码流
+    int encode_buffer(MppBuffer input, PacketBuffer* out_data, size_t* out_len, bool* is_key);
+
 private:
     int width = 0;
     int height = 0;
@@ -50,4 +89,8 @@ private:
     // 零拷贝关键：这是 MPP 分配的物理连续内存
     // RGA 往这里写，MPP 从这里读
     MppBuffer shared_input_buf = nullptr;
+
+    // DMABUF 采集模式用的输入池：摄像头直接写，编码器直接读
+    MppBufferGroup input_group = nullptr;
+    std::vector<MppBuffer> input_pool;
 };
@@ -0,0 +1,40 @@
+#pragma once
+#include <rockchip/rk_mpi.h>
+#include <rockchip/mpp_buffer.h>
+#include <rockchip/mpp_meta.h>
+#include <vector>
+#include "video/jpeg_decoder.h"
+
+// MPP 硬件 MJPEG 解码：输出 NV12，直接落在 DRM dma-buf 里，
+// 后面 RGA 用 fd 读，不经过 CPU
+class MppJpegDecoder : public JpegDecoder {
+public:
+    MppJpegDecoder();
+    ~MppJpegDecoder();
+
+    int init(int width, int height, int slot_count) override;
+    int decode(const void* data, size_t size, int slot, DecodedFrame* out) override;
+    int get_format() const override;
+    const char* get_name() const override { return "mpp"; }
+
+    void deinit();
+
+private:
+    int width_ = 0;
+    int height_ = 0;
+    int hor_stride_ = 0;
+    int ver_stride_ = 0;
+
+    MppCtx ctx_ = nullptr;
+    MppApi* mpi_ = nullptr;
+
+    // 码流输入：JPEG 拷进这块 DRM 内存再送给硬件 (一帧也就几百 KB)
+    MppBufferGroup packet_group_ = nullptr;
+    MppBuffer packet_buf_ = nullptr;
+    size_t packet_size_ = 0;
+
+    // 解码输出：每个 slot 一块
+    MppBufferGroup frame_group_ = nullptr;
+    std::vector<MppBuffer> frame_bufs_;
+    bool warned_format_ = false;
+};
@@ -1,9 +1,57 @@
 #pragma once
 #include <rga/im2d.h> // RGA 的核心头文件
 #include <rga/RgaApi.h>
+#include <cstddef>
+#include <cstdint>
 
 // 初始化 RGA (其实主要是打印一下版本)
 int init_rga();
 
 int rga_convert(void* src_ptr, int src_fd, int src_w, int src_h, int src_fmt,
-                void* dst_ptr, int dst_fd, int dst_w, int dst_h, int dst_fmt);
\ No newline at end of file
+                void* dst_ptr, int dst_fd, int dst_w, int dst_h, int dst_fmt);
+
+// 同上，但源带行跨度：wstride 像素一行，hstride 行一个平面
+// (MPP 解码输出按 16 对齐，1080p 的 UV 平面在 1088 行之后)
+int rga_convert_stride(void* src_ptr, int src_fd, int src_w, int src_h, int src_wstride, int src_hstride, int src_fmt,
+                       void* dst_ptr, int dst_fd, int dst_w, int dst_h, int dst_fmt);
+
+// 一张图 (fd > 0 走 dma-buf，否则走虚拟地址)
+struct RgaImage {
+    void* ptr;
+    int fd;
+    int width;
+    int height;
+    int wstride;    // 一行多少像素
+    int hstride;    // 一个平面多少行
+    int format;
+};
+
+// 封装成 rga_buffer_t (优先用缓存的句柄，见下面的句柄缓存)
+rga_buffer_t rga_wrap(const RgaImage& img);
+
+// 一个源转换/缩放成多个目标，放进同一个 RGA job 一次提交并等完 (异步用法见 rga_job.h)
+int rga_convert_batch(const RgaImage& src, const RgaImage* dsts, int count);
+
+// ---------------------------------------------------------------- 句柄缓存
+// 每次 wrapbuffer_fd/virtualaddr，驱动都要重新查 dma-buf / 锁定映射用户页；
+// 这里第一次用到某块内存时 importbuffer 一次，之后复用句柄，直到拥有者释放内存。
+// fd 按 dma-buf 的 inode 校验，虚拟地址没法校验；缓存有上限，超了淘汰最久没用的句柄。
+// 注意：内存释放 (或 fd 关闭) 之前必须调用 rga_release_*，否则句柄会指向旧内存。
+
+// 按 fd / 虚拟地址取句柄 (没有就导入)，size 是内存大小 (字节)；失败返回 0
+rga_buffer_handle_t rga_import_fd(int fd, size_t size);
+rga_buffer_handle_t rga_import_virt(void* ptr, size_t size);
+
+// 释放缓存的句柄 (没缓存过也可以调)
+void rga_release_fd(int fd);
+void rga_release_virt(void* ptr);
+// 释放 [base, base+size) 内所有虚拟地址句柄 (一块大映射里按帧偏移导入的那种)
+void rga_release_virt_range(void* base, size_t size);
+
+struct RgaCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions; // 超过上限被淘汰的句柄数 (一直涨说明上限太小，或者有临时内存在走缓存)
+    size_t entries;   // 当前缓存的句柄数
+};
+RgaCacheStats rga_cache_stats();
@@ -0,0 +1,13 @@
+#pragma once
+#include "video/rga.h"
+#include "video/cpu_convert.h"
+
+// RGA 转换的 CPU 后备：按 RgaImage 描述调用 cpu_convert.h 里的 SIMD 实现
+// (cpu_convert 本身不依赖 librga，RgaImage 的格式映射放在这里)
+
+// 必须有 ptr，只支持 YUYV->NV12、RGB->NV12 (同尺寸) 和 NV12->RGB (可缩放)
+bool cpu_convert_supported(const RgaImage& src, const RgaImage& dst);
+// 返回 0 成功, -1 不支持。调用者负责 dma-buf 的 CPU 访问同步
+// cache 只有带缩放的 NV12 -> RGB 用得到，见 CpuScaleCache
+int cpu_convert_image(const RgaImage& src, const RgaImage& dst, CpuIsa isa = CPU_ISA_AUTO,
+                      CpuScaleCache* cache = nullptr);
@@ -0,0 +1,81 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include "video/rga.h"
+
+// 一组 RGA 操作，攒起来一次提交
+// 同步的 imcvtcolor 每做一步都要等一次内核往返；这里先 add_* 把几步排好，
+// submit() 异步提交 (拿到 release fence 就返回)，CPU 可以接着干别的，要用结果时再 wait()。
+//
+//   RgaJob job;
+//   job.add_convert(src, ai_img);
+//   job.add_convert(src, enc_img);
+//   job.submit();
+//   ... CPU 做别的 ...
+//   job.wait();
+//
+// librga 不支持 job 接口 (imbeginJob 失败) 时，submit() 里逐个同步执行，用法不变。
+// 一个 RgaJob 可以反复用：wait() 之后再 add_* / submit()。
+class RgaJob {
+public:
+    // 完成回调，参数 0 成功 / -1 失败；在调用 wait()/poll() 的线程里执行
+    typedef std::function<void(int)> Callback;
+
+    RgaJob();
+    ~RgaJob();   // 还没完成的会先等完
+    RgaJob(const RgaJob&) = delete;
+    RgaJob& operator=(const RgaJob&) = delete;
+
+    // 格式转换 + 缩放 (整幅 src -> 整幅 dst)
+    void add_convert(const RgaImage& src, const RgaImage& dst);
+    // 通用操作：src 的 srect 区域按 usage (比如 IM_ALPHA_BLEND_SRC_OVER) 处理到 dst 的 drect
+    void add_process(const RgaImage& src, const RgaImage& dst, const im_rect& srect, const im_rect& drect,
+                     int usage);
+    // 把 dst 的 rect 区域填成纯色 (color 按 0xAABBGGRR)
+    void add_fill(const RgaImage& dst, const im_rect& rect, uint32_t color);
+    int task_count() const { return (int)tasks_.size(); }
+
+    /**
+     * @brief 异步提交排好的所有操作
+     * @param on_done 完成回调 (可以为空)
+     * @return 0 已提交 (或者已经同步做完), -1 失败 (失败时回调也会被调用)
+     */
+    int submit(Callback on_done = nullptr);
+
+    /**
+     * @brief 等提交的操作完成，然后执行回调
+     * @param timeout_ms -1 一直等
+     * @return 0 成功, -1 失败或超时 (超时的话下次还可以接着等)
+     */
+    int wait(int timeout_ms = -1);
+
+    // 不等，看一眼完成了没有 (完成了就执行回调)；返回 true 表示没有进行中的操作
+    bool poll();
+
+    // 提交并等完 (同步用法)
+    int run() { return (submit() == 0) ? wait() : -1; }
+
+    bool pending() const { return submitted_; }
+    // 进行中的 release fence (sync_file fd，可以交给别的模块等)，没有为 -1
+    int release_fence() const { return fence_fd_; }
+
+private:
+    struct Task {
+        rga_buffer_t src;
+        rga_buffer_t dst;
+        im_rect srect;
+        im_rect drect;
+        int usage;
+        bool fill;        // true: 填色 (只用 dst/drect/color)
+        uint32_t color;
+    };
+    int run_sync();
+    void finish(int result);
+
+private:
+    std::vector<Task> tasks_;
+    bool submitted_ = false;
+    int fence_fd_ = -1;
+    int result_ = 0;
+    Callback on_done_;
+};
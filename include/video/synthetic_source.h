@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include "video/frame_source.h"
+
+// 合成测试图源 (NV12)：斜向滚动的亮度渐变 + 彩条 + 一个来回移动的白块
+// 每帧都不一样，编码器能看到真实的运动；源本身不依赖任何硬件 (下游编码仍然要 MPP)。
+class SyntheticFrameSource : public FrameSource {
+public:
+    // paced: true 按 fps 出帧，false 全速出帧 (测吞吐用)
+    explicit SyntheticFrameSource(bool paced, int buffer_count = 4);
+    ~SyntheticFrameSource();
+
+    int open(int width, int height, int fps) override;
+    int start() override;
+    void stop() override;
+    bool acquire(SourceFrame* frame, int timeout_ms) override;
+    void release(int index) override;
+    int get_format() const override;
+    int get_width() const override { return width_; }
+    int get_height() const override { return height_; }
+    uint64_t get_skipped() const override { return skipped_; }
+    const char* get_name() const override { return "synthetic"; }
+
+private:
+    // 把第 n 帧画到 buf 里
+    void render(uint8_t* buf, uint32_t n);
+
+private:
+    bool paced_;
+    int width_ = 0;
+    int height_ = 0;
+    int fps_ = 30;
+    size_t frame_size_ = 0;
+
+    std::vector<uint8_t*> buffers_;
+    std::vector<bool> in_use_;   // 被下游拿着还没 release 的
+    int next_ = 0;
+    uint32_t sequence_ = 0;
+    uint64_t skipped_ = 0;       // 没有空闲 buffer 时跳过的帧
+
+    FramePacer pacer_;
+    std::atomic<bool> running_{false};
+};
@@ -0,0 +1,23 @@
+#pragma once
+#include <vector>
+#include "video/jpeg_decoder.h"
+
+// libjpeg-turbo 软件解码：输出 RGB888 到普通内存 (RGA 走虚拟地址)
+// 比硬解慢很多，1080p 跑不满 30 帧；用来在没有 MPP 的机器上调试 MJPEG 采集，
+// 或者对比硬解的画面。编译时找到 libturbojpeg 才有 (HAVE_TURBOJPEG)。
+class TurboJpegDecoder : public JpegDecoder {
+public:
+    TurboJpegDecoder();
+    ~TurboJpegDecoder();
+
+    int init(int width, int height, int slot_count) override;
+    int decode(const void* data, size_t size, int slot, DecodedFrame* out) override;
+    int get_format() const override;
+    const char* get_name() const override { return "turbojpeg"; }
+
+private:
+    int width_ = 0;
+    int height_ = 0;
+    void* handle_ = nullptr;            // tjhandle
+    std::vector<unsigned char*> bufs_;  // 每个 slot 一块 RGB
+};
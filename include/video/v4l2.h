@@ -1,5 +1,9 @@
 #pragma once
 #include <linux/videodev2.h> // 为了能引用 v4l2_buffer 类型
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
 
 // 自定义结构体：描述一个图像缓冲区
 struct CameraBuffer {
@@ -8,27 +12,118 @@ struct CameraBuffer {
     int export_fd;  // 【关键】DMA-BUF 文件描述符 (给 RGA/MPP 用的)
     int index;      // 在 V4L2 队列中的编号 (0, 1, 2, 3)
 };
-static int g_buf_type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-
-
-int query_device_info(const char* dev_name);
-
-int open_camera(int fd, int width, int height,int fps);
-// 新增：申请并映射缓冲区
-// 参数：fd (摄像头描述符), count (想要申请几个，通常传指针以便返回实际申请数)
-// 返回值：返回一个 CameraBuffer 数组的首地址
-CameraBuffer* map_buffers(int fd, int* count);
-// 1. 启动摄像头 (把所有空buffer入队，并开启流)
-int start_capturing(int fd, int buffer_count);
-// 2. 停止摄像头 (关闭流)
-void stop_capturing(int fd);
-// 3. 等待并取出最新的一帧 (DQBUF)
-// 返回值：>=0 表示成功取到的 buffer index，-1 表示失败
-int wait_and_get_frame(int fd);
-// 4. 处理完后归还 buffer (QBUF)
-// 参数：index 是你刚才取出的那个 buffer 的编号
-int return_frame(int fd, int index);
-// 新增：释放资源
-void release_buffers(CameraBuffer* buffers, int count);
-
-int get_v4l2_buf_type();
+
+// 驱动随帧返回的信息 (DQBUF 时填)
+struct FrameInfo {
+    int index;             // buffer 编号
+    int64_t timestamp_us;  // 采集时间戳 (CLOCK_MONOTONIC，微秒)
+    uint32_t sequence;     // 驱动帧序号，不连续说明传感器/驱动丢了帧
+    size_t bytesused;      // 有效数据长度
+};
+
+// 枚举出来的一种采集模式 (格式 + 分辨率 + 最高帧率)
+struct CaptureMode {
+    uint32_t pixelformat;  // V4L2_PIX_FMT_*
+    uint32_t width;        // 离散分辨率就是它本身；范围型是协商后的值 (枚举时填最大值)
+    uint32_t height;
+    bool is_range;         // 分辨率是范围 (STEPWISE/CONTINUOUS)
+    uint32_t min_width, min_height, max_width, max_height;
+    uint32_t step_width, step_height;
+    double max_fps;        // 这个分辨率下驱动支持的最高帧率，0 表示驱动没报
+};
+
+// 一个 V4L2 采集设备：fd、buffer 类型、内存模式、缓冲区和格式都在对象里，
+// 多个摄像头各用一个对象，互不影响。
+class V4L2Device {
+public:
+    V4L2Device();
+    ~V4L2Device();
+
+    V4L2Device(const V4L2Device&) = delete;
+    V4L2Device& operator=(const V4L2Device&) = delete;
+
+    // 打开设备，确定是 MIPI (MPLANE) 还是 USB，枚举并记下所有 格式/分辨率/帧率
+    // 返回值：fd，-1 失败
+    int open_device(const char* dev_name);
+    // 设置分辨率/帧率：按 select_mode 的策略从枚举结果里挑格式，
+    // 驱动没报能力时退回 MIPI 用 NV12，USB 用 YUYV
+    int set_format(int width, int height, int fps);
+    // 采集模式选择策略：
+    //   1. 分辨率不小于目标的优先 (RGA 只缩小，不放大)
+    //   2. 能达到目标帧率的优先
+    //   3. 格式按转换代价：H264 (直通) -> NV12 -> YUYV -> MJPEG (只在 accepted 列表里挑)
+    //   4. 分辨率正好等于目标的优先，再选最高帧率，最后选比目标大的里面最小的
+    // 返回值：0 找到 (out 填好实际要设的宽高)，-1 没有可用模式
+    int select_mode(int width, int height, int fps, CaptureMode* out) const;
+    // 下游能处理哪些格式 (默认 NV12/YUYV)
+    void set_accepted_formats(const std::vector<uint32_t>& formats);
+    const std::vector<CaptureMode>& get_modes() const { return modes_; }
+    // 申请并映射缓冲区 (MMAP + EXPBUF)
+    // 返回值：实际申请到的数量 (驱动可能给得比 count 少)，-1 失败
+    int map_buffers(int count);
+    // DMABUF 导入模式：让驱动直接写进外部分配的 dma-buf (比如 MPP 编码器的输入内存)
+    // 代替 map_buffers，之后 start/dequeue/return 都自动按 DMABUF 方式入队
+    // 参数：dma_fds 外部内存的 fd 数组，length 每块大小
+    // 返回值：实际申请到的数量，-1 失败 (驱动不支持，此时仍是 MMAP 模式)
+    int import_dmabufs(const int* dma_fds, int count, size_t length);
+
+    // 1. 启动摄像头 (把所有空buffer入队，并开启流)
+    int start_capturing();
+    // 2. 停止摄像头 (关闭流)
+    void stop_capturing();
+    // 3. 等待并取出最新的一帧 (DQBUF)
+    // 返回值：>=0 表示成功取到的 buffer index，-1 表示失败
+    // info: 可选，返回驱动的时间戳和帧序号
+    int wait_and_get_frame(FrameInfo* info = nullptr);
+    // 3.1 不等待，直接出队一帧 (给 epoll 采集线程用)
+    // 返回值：>=0 buffer index，-1 暂时没有帧 (EAGAIN)，-2 出错
+    int dequeue_frame(FrameInfo* info = nullptr);
+    // 4. 处理完后归还 buffer (QBUF)
+    // 参数：index 是你刚才取出的那个 buffer 的编号
+    int return_frame(int index);
+    // 关流、释放缓冲区、关闭设备 (析构时自动调用)
+    void close_device();
+
+    int get_fd() const { return fd_; }
+    const std::string& get_dev_name() const { return dev_name_; }
+    int get_buf_type() const { return buf_type_; }
+    // 当前的内存模式：V4L2_MEMORY_MMAP 或 V4L2_MEMORY_DMABUF
+    int get_memory() const { return memory_; }
+    int get_buffer_count() const { return buffer_count_; }
+    // MMAP 模式下映射出的缓冲区 (DMABUF 模式下为空)
+    const CameraBuffer& get_buffer(int index) const { return buffers_[index]; }
+    // 第 index 块的 DMA-BUF fd (MMAP 模式是导出的 fd，DMABUF 模式是导入的外部 fd)
+    int get_dma_fd(int index) const;
+    // S_FMT 之后驱动实际给的像素格式 (V4L2_PIX_FMT_*)
+    uint32_t get_pixelformat() const { return fmt_pixelformat_; }
+    // S_FMT 之后驱动实际给的格式 (分辨率/行跨度/单帧大小)，任意参数可传 nullptr
+    void get_format(uint32_t* width, uint32_t* height, uint32_t* bytesperline, uint32_t* sizeimage) const;
+
+private:
+    // 按当前内存模式填好 v4l2_buffer (DMABUF 模式要带上 fd)
+    void fill_buffer(struct v4l2_buffer* buf, struct v4l2_plane* planes, int index);
+    void release_buffers();
+    double query_max_fps(uint32_t pixelformat, uint32_t width, uint32_t height);
+
+private:
+    int fd_ = -1;
+    std::string dev_name_;
+    int buf_type_ = V4L2_BUF_TYPE_VIDEO_CAPTURE;   // MIPI 是 MPLANE，USB 是普通 CAPTURE
+    int memory_ = V4L2_MEMORY_MMAP;                // import_dmabufs 成功后切到 DMABUF
+    bool streaming_ = false;
+    int buffer_count_ = 0;
+
+    std::vector<CameraBuffer> buffers_;  // MMAP 模式映射出的内存
+    std::vector<int> dmabuf_fds_;        // DMABUF 模式下每个 index 对应的外部 fd
+    size_t dmabuf_length_ = 0;
+
+    std::vector<CaptureMode> modes_;     // open_device 时枚举出来的所有模式
+    std::vector<uint32_t> accepted_formats_ = {V4L2_PIX_FMT_NV12, V4L2_PIX_FMT_YUYV};
+
+    // S_FMT 之后驱动实际给的格式
+    uint32_t fmt_pixelformat_ = 0;
+    uint32_t fmt_width_ = 0;
+    uint32_t fmt_height_ = 0;
+    uint32_t fmt_bytesperline_ = 0;
+    uint32_t fmt_sizeimage_ = 0;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "video/frame_source.h"
+#include "video/v4l2.h"
+#include "video/capture_thread.h"
+#include "video/jpeg_decoder.h"
+
+// 摄像头视频源：V4L2Device + 独立采集线程
+// 格式/分辨率由 V4L2Device 按设备能力协商 (NV12 优先，其次 YUYV)
+// 给了 JPEG 解码器的话也接受 MJPEG：USB 摄像头 1080p30 基本只有 MJPEG，
+// acquire 里解码，出来的是解码器的输出内存，V4L2 buffer 解完马上还给驱动
+// 开了 H.264 直通的话也接受 H264：每个 V4L2 buffer 是一帧码流，按顺序交给下游，一帧不丢
+class V4L2FrameSource : public FrameSource {
+public:
+    // decoder: MJPEG 解码器 (可以为 nullptr，不接受 MJPEG)，所有权交给 V4L2FrameSource
+    explicit V4L2FrameSource(const std::string& dev_name, int buffer_count = 4,
+                             JpegDecoder* decoder = nullptr);
+    ~V4L2FrameSource();
+
+    int open(int width, int height, int fps) override;
+    // 如果 open 之后已经 import_dmabufs 过了，就不再 map_buffers
+    int start() override;
+    void stop() override;
+    bool acquire(SourceFrame* frame, int timeout_ms) override;
+    void release(int index) override;
+    int get_format() const override;
+    int get_width() const override;
+    int get_height() const override;
+    bool is_encoded() const override { return h264_; }
+    uint64_t get_skipped() const override { return capture_.get_skipped(); }
+    const char* get_name() const override { return dev_name_.c_str(); }
+
+    // 允许摄像头直接出 H.264 (open 之前调用)
+    void set_h264_passthrough(bool enable) { allow_h264_ = enable; }
+
+    // 给 DMABUF 零拷贝用：open 之后、start 之前可以直接操作设备
+    V4L2Device& device() { return camera_; }
+
+private:
+    std::string dev_name_;
+    int buffer_count_;
+    V4L2Device camera_;
+    CaptureThread capture_;   // 析构时先于 camera_ 停止
+
+    // MJPEG 模式
+    JpegDecoder* decoder_;
+    bool mjpeg_ = false;
+    std::vector<bool> slot_in_use_;   // 解码输出内存，被下游拿着还没 release 的
+    uint64_t decode_errors_ = 0;
+
+    // H.264 直通模式
+    bool allow_h264_ = false;
+    bool h264_ = false;
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <map>
 #include "rknn_api.h"
 #include "yolov8/postprocess.h" 
 
@@ -22,12 +23,23 @@ public:
     int init(const char* model_path);
 
     // 推理：传入 RGA 转换后的 RGB 数据指针
+    // input_fd 是同一块内存的 dma-buf fd：有的话 NPU 直接读这块内存 (零拷贝)，
+    // 为 -1 (或零拷贝设置失败) 时按老办法让 rknn 拷一份
+    // lb 是输入图的 letterbox 参数 (make_letterbox 算的)，框按它换算回原图坐标；
+    // 为空时输入当成整幅拉伸到模型尺寸，框是模型输入 (640x640) 上的坐标
     // 返回检测到的物体列表
-    std::vector<Object> detect(void* input_data);
+    std::vector<Object> detect(void* input_data, int input_fd = -1, const letterbox_t* lb = nullptr);
+
+    // 保持宽高比把 src_w x src_h 的图放进模型输入：等比缩放，居中，上下或左右补边
+    // 缩放后的宽高和边距都是偶数 (RGA/NV12 的要求)，两边的边距相等；
+    // 为此缩放后的尺寸可能少取几个像素，所以横竖两个方向的比例分开给 (scale_x/scale_y)
+    letterbox_t make_letterbox(int src_w, int src_h) const;
 
 private:
     // 读取文件辅助函数
     unsigned char* load_model(const char* filename, int* model_size);
+    // 把 dma-buf 绑成模型输入 (每个 fd 只建一次 rknn_tensor_mem)，失败返回 -1
+    int bind_input_fd(int fd, void* virt);
 
 private:
 
@@ -35,4 +47,9 @@ private:
 
     unsigned char* model_data;      // 模型二进制数据
 
+    // 零拷贝输入：每路一块输入内存，fd -> rknn 内存对象
+    std::map<int, rknn_tensor_mem*> input_mems;
+    int bound_fd = -1;              // 当前绑在输入上的 fd
+    bool zero_copy_failed = false;  // 驱动不支持就不再试了
+
 };
\ No newline at end of file
@@ -26,7 +26,8 @@ typedef struct {
 typedef struct {
     int target_width;
     int target_height;
-    float scale;
+    float scale_x;      // 缩放后宽 / 原图宽 (宽高取整后两个方向会略有不同，分开存才能精确换算回去)
+    float scale_y;      // 缩放后高 / 原图高
     int x_pad;
     int y_pad;
 } letterbox_t;
@@ -3,6 +3,16 @@
 
 using namespace std;
 
+// 消费线程每次最多取多少包，以及空队列时最多等待多久
+static const size_t QUEUE_BATCH_SIZE = 64;
+static const std::chrono::milliseconds QUEUE_POP_TIMEOUT(100);
+// 每路摄像头申请的 V4L2 缓冲区数量
+static const int CAMERA_BUFFER_COUNT = 4;
+
+// 预览层 NV12 的行跨度 (RGA 输出要求 16 对齐) 和平面高度 (偶数)
+static int preview_hor_stride(int width) { return (width + 15) & ~15; }
+static int preview_ver_stride(int height) { return (height + 1) & ~1; }
+
 // 获取时间戳
 static uint32_t get_time_ms() {
     struct timeval tv;
@@ -12,15 +22,36 @@ static uint32_t get_time_ms() {
 
 // 获取当前时间字符串 "2026-01-21 16:20:00"
 static std::string get_current_time_string() {
+    // 每路的视频线程和录像线程会同时调用，用 localtime_r (localtime 返回的是共享的静态缓冲)
     auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::tm tm_now;
+    localtime_r(&now, &tm_now);
     std::stringstream ss;
-    ss << std::put_time(std::localtime(&now), "%Y-%m-%d %H:%M:%S");
+    ss << std::put_time(&tm_now, "%Y-%m-%d %H:%M:%S");
     return ss.str();
 }
 
-StreamerApp::StreamerApp() :
-            m_queue(60, "StreamQueue"),       // 推流队列：叫 "StreamQueue"
-            m_record_queue(60, "RecordQueue") // 录像队列：叫 "RecordQueue" 
+// 按配置生成队列预算 (字节 + 时长，保证内存和延迟都有上限)，音视频分通道各自独立
+static QueueLimits make_limits(size_t packets, size_t bytes, uint32_t ms) {
+    QueueLimits limits;
+    limits.max_packets     = packets;
+    limits.max_bytes       = bytes;
+    limits.max_duration_ms = ms;
+    return limits;
+}
+
+CameraPipeline::CameraPipeline(int id, const AppConfig& config) :
+            id(id),
+            stream_queue(make_limits(config.stream_queue_packets, config.stream_queue_bytes, config.stream_queue_ms),
+                         make_limits(0, config.stream_audio_queue_bytes, config.stream_audio_queue_ms),
+                         id == 0 ? "StreamQueue" : "StreamQueue[cam" + std::to_string(id) + "]", DROP_GOP),
+            record_queue(make_limits(config.record_queue_packets, config.record_queue_bytes, config.record_queue_ms),
+                         make_limits(0, config.record_audio_queue_bytes, config.record_audio_queue_ms),
+                         id == 0 ? "RecordQueue" : "RecordQueue[cam" + std::to_string(id) + "]", DROP_GOP)
+{
+}
+
+StreamerApp::StreamerApp()
 {
     // 初始化状态
     m_is_running = false;
@@ -36,67 +67,175 @@ bool StreamerApp::init(const AppConfig& config) {
 
     cout << ">>[App] 正在初始化..." << endl;
 
-    // 1. 打开摄像头
-    m_camera_fd = query_device_info(m_config.dev_name.c_str());
-    if (m_camera_fd < 0) {
-        cerr << ">>[V4L2] 无法打开摄像头设备: " << m_config.dev_name << endl;
+    // 0. 每路摄像头一条管线：第 0 路用原来的流 ID 和录像目录，后面的加 camN 区分
+    std::vector<std::string> dev_names;
+    dev_names.push_back(m_config.dev_name);
+    dev_names.insert(dev_names.end(), m_config.extra_dev_names.begin(), m_config.extra_dev_names.end());
+
+    // 中间帧内存池 (dma_heap，没有就退回 memfd)
+    m_buffer_pool.init();
+    cout << ">>[CPU] 颜色转换后备实现: " << cpu_isa_name(CPU_ISA_AUTO) << endl;
+
+    for (size_t i = 0; i < dev_names.size(); ++i) {
+        CameraPipeline* p = new CameraPipeline((int)i, m_config);
+        p->dev_name = dev_names[i];
+        p->stream_id = m_config.stream_id;
+        p->record_dir = m_config.record_dir;
+        if (i > 0) {
+            p->stream_id += "_cam" + std::to_string(i);
+            p->record_dir += "/cam" + std::to_string(i);
+        }
+        m_pipelines.push_back(p);
+
+        if (!initPipeline(p)) {
+            cerr << ">>[App] 第 " << i << " 路摄像头初始化失败: " << p->dev_name << endl;
+            return false;
+        }
+    }
+
+    // 1. 初始化 RGA
+    if (init_rga() < 0) {
+        cerr << ">>[RGA] 初始化失败" << endl;
         return false;
     }
-    open_camera(m_camera_fd, m_config.width, m_config.height, m_config.fps);
-    cout << ">>[V4L2] 摄像头打开成功: " << m_config.dev_name << endl;
+    cout << ">>[RGA] 初始化成功" << endl;
 
-    if (get_v4l2_buf_type() == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
-        // MIPI 摄像头 -> NV12
-        m_src_format = RK_FORMAT_YCbCr_420_SP;
-        printf(">>[V4L2] 源模式: MIPI (NV12)\n");
-    } else {
-        // USB 摄像头 -> YUYV
-        m_src_format = RK_FORMAT_YUYV_422;
-        printf(">>[V4L2] 源模式: USB (YUYV)\n");
+    // 2. 初始化 AI 模型 (多路共用一个)，不开 AI 就不加载，没有 NPU/模型文件也能跑
+    if (m_config.enable_ai) {
+        m_detector = new YoloDetector();
+        if (m_detector->init(m_config.model_path.c_str()) != 0) {
+            cerr << ">>[Yolo] AI模型初始化失败，检查模型路径: " << m_config.model_path << endl;
+            return false;
+        }
+        cout << ">>[Yolo] AI模型加载成功: " << m_config.model_path << endl;
     }
 
-    // 2. 映射缓冲区
-    m_camera_buffers = map_buffers(m_camera_fd, &m_n_buffers);
-    if (!m_camera_buffers) {
-        cerr << ">>[V4L2] 映射缓冲区失败" << endl;
+    cout << ">>[App] 初始化完成，摄像头数量: " << m_pipelines.size() << endl;
+    return true;
+}
+
+// 初始化一路摄像头
+bool StreamerApp::initPipeline(CameraPipeline* p) {
+    // 1. 打开视频源 (摄像头/文件回放/合成图)
+    p->source = createFrameSource(p->dev_name);
+    if (!p->source || p->source->open(m_config.width, m_config.height, m_config.fps) < 0) {
+        cerr << ">>[Source] 视频源打开失败: " << m_config.source_type << endl;
         return false;
     }
-    start_capturing(m_camera_fd, m_n_buffers);
-    cout << ">>[V4L2] 摄像头初始化成功" << endl;
 
-    // 3. 初始化 RGA
-    if (init_rga() < 0) {
-        cerr << ">>[RGA] 初始化失败" << endl;
-        return false;
+    // 摄像头直接出 H.264：不需要编码器和 RGA，也没有图像可以给 AI
+    if (p->source->is_encoded()) {
+        p->passthrough = true;
+        if (m_config.enable_ai) {
+            cout << ">>[App] H.264 直通模式下没有原始图像，这一路不做 AI 检测" << endl;
+        }
+        if (p->source->start() < 0) {
+            cerr << ">>[Source] 视频源启动失败: " << p->source->get_name() << endl;
+            return false;
+        }
+        return true;
     }
-    cout << ">>[RGA] 初始化成功" << endl;
 
-    // 4. 初始化 MPP 编码器
-    m_encoder = new MppEncoder();
-    if (m_encoder->init(m_config.width, m_config.height, m_config.fps) < 0) {
+    // 2. 初始化 MPP 编码器 (DMABUF 模式要用它的内存，所以放在缓冲区之前)
+    if (p->encoder.init(m_config.width, m_config.height, m_config.fps) < 0) {
         cerr << ">>[MPP] 编码器初始化失败" << endl;
         return false;
     }
     cout << ">>[MPP] 编码器初始化成功" << endl;
 
-    // 5. 初始化 AI 模型
-    m_detector = new YoloDetector();
-    if (m_detector->init(m_config.model_path.c_str()) != 0) {
-        cerr << ">>[Yolo] AI模型初始化失败，检查模型路径: " << m_config.model_path << endl;
+    // 3. 缓冲区：摄像头能零拷贝就直接采进编码器内存，否则由视频源自己分配
+    V4L2FrameSource* v4l2_source = dynamic_cast<V4L2FrameSource*>(p->source);
+    p->zero_copy = v4l2_source && setupZeroCopyCapture(p, v4l2_source->device());
+    if (p->source->start() < 0) {
+        cerr << ">>[Source] 视频源启动失败: " << p->source->get_name() << endl;
         return false;
     }
-    cout << ">>[Yolo] AI模型加载成功: " << m_config.model_path << endl;
 
-    // 6. 分配专用内存池
-    m_ai_buf = malloc(640 * 640 * 3); // 给 AI 用
-    m_draw_buf = malloc(m_config.width * m_config.height * 3); // 给 OpenCV 画图用
-    if (!m_ai_buf || !m_draw_buf) {
+    // 4. 分配专用内存池
+    // 预览层 (可选)
+    if (m_config.preview_width > 0 && m_config.preview_height > 0) {
+        size_t size = (size_t)preview_hor_stride(m_config.preview_width)
+                    * preview_ver_stride(m_config.preview_height) * 3 / 2;
+        if (m_buffer_pool.acquire(size, &p->preview_buf) < 0) {
+            cerr << ">>[内存] 预览内存分配失败，不生成预览" << endl;
+        }
+    }
+    if (m_buffer_pool.acquire(640 * 640 * 3, &p->ai_buf) < 0) { // 给 AI 用
         cerr << ">>[内存] 专用内存池分配失败" << endl;
         return false;
     }
     cout << ">>[内存] 专用内存池分配成功" << endl;
+    return true;
+}
 
-    cout << ">>[App] 初始化完成" << endl;
+// 按配置创建视频源
+FrameSource* StreamerApp::createFrameSource(const std::string& dev_name) {
+    if (m_config.source_type == "v4l2") {
+        V4L2FrameSource* source = new V4L2FrameSource(dev_name, CAMERA_BUFFER_COUNT, createJpegDecoder());
+        source->set_h264_passthrough(m_config.h264_passthrough);
+        return source;
+    }
+    if (m_config.source_type == "file") {
+        return new FileFrameSource(m_config.source_file, m_config.source_format, m_config.source_paced);
+    }
+    if (m_config.source_type == "synthetic") {
+        return new SyntheticFrameSource(m_config.source_paced);
+    }
+    cerr << ">>[Source] 未知的视频源类型: " << m_config.source_type
+         << " (支持 v4l2/file/synthetic)" << endl;
+    return nullptr;
+}
+
+// 按配置创建 MJPEG 解码器 (nullptr 表示不接受 MJPEG)
+JpegDecoder* StreamerApp::createJpegDecoder() {
+    if (m_config.mjpeg_decoder == "mpp") {
+        return new MppJpegDecoder();
+    }
+    if (m_config.mjpeg_decoder == "turbojpeg") {
+#ifdef HAVE_TURBOJPEG
+        return new TurboJpegDecoder();
+#else
+        cerr << ">>[Source] 编译时没有找到 libturbojpeg，不使用 MJPEG" << endl;
+        return nullptr;
+#endif
+    }
+    if (!m_config.mjpeg_decoder.empty()) {
+        cerr << ">>[Source] 未知的 MJPEG 解码器: " << m_config.mjpeg_decoder
+             << " (支持 mpp/turbojpeg)" << endl;
+    }
+    return nullptr;
+}
+
+// DMABUF 零拷贝采集
+// 条件：摄像头出 NV12、分辨率和编码器一致、行跨度/平面偏移和 MPP 的布局一样、不开 AI
+// (AI 要先转 RGB 画框再转回来，本来就有拷贝，没必要)
+bool StreamerApp::setupZeroCopyCapture(CameraPipeline* p, V4L2Device& camera) {
+    if (!m_config.capture_dmabuf || m_config.enable_ai) return false;
+    if (camera.get_pixelformat() != V4L2_PIX_FMT_NV12) return false;
+
+    MppEncoder& encoder = p->encoder;
+    uint32_t w = 0, h = 0, bytesperline = 0, sizeimage = 0;
+    camera.get_format(&w, &h, &bytesperline, &sizeimage);
+    if ((int)w != m_config.width || (int)h != m_config.height) {
+        printf(">>[V4L2] 驱动分辨率 %ux%u 和编码器不一致，不走零拷贝\n", w, h);
+        return false;
+    }
+    // V4L2 的 UV 平面紧跟在 bytesperline*height 后面，MPP 要求在 hor_stride*ver_stride 后面
+    if ((int)bytesperline != encoder.get_hor_stride() || (int)h != encoder.get_ver_stride()) {
+        printf(">>[V4L2] 行跨度 %u 和 MPP 布局 (%dx%d) 不一致，不走零拷贝\n",
+               bytesperline, encoder.get_hor_stride(), encoder.get_ver_stride());
+        return false;
+    }
+    if (sizeimage > encoder.get_frame_size()) return false;
+
+    std::vector<int> fds(CAMERA_BUFFER_COUNT, -1);
+    if (encoder.alloc_input_pool(CAMERA_BUFFER_COUNT, fds.data()) < 0) return false;
+
+    if (camera.import_dmabufs(fds.data(), CAMERA_BUFFER_COUNT, encoder.get_frame_size()) < 0) {
+        printf(">>[V4L2] 驱动不支持 DMABUF 导入，退回 MMAP\n");
+        return false;
+    }
+    printf(">>[V4L2] 零拷贝采集已开启 (摄像头 -> MPP)\n");
     return true;
 }
 
@@ -108,15 +247,17 @@ void StreamerApp::start( ) {
 
     m_is_running = true;
 
-    if (m_config.enable_stream) {
-        cout << ">>[App] 启动推流线程..." << endl;
-        // 启动网络推流线程
-        m_net_thread = new std::thread(&StreamerApp::networkWorker, this);
-    }
-    if(m_config.enable_record) {
-        cout << ">>[App] 启动本地录像线程..." << endl;
-        // 启动本地录像线程
-        m_record_thread = new std::thread(&StreamerApp::recordWorker, this);
+    for (CameraPipeline* p : m_pipelines) {
+        if (m_config.enable_stream) {
+            cout << ">>[App] 启动推流线程... (" << p->stream_id << ")" << endl;
+            // 启动网络推流线程
+            p->net_thread = new std::thread(&StreamerApp::networkWorker, this, p);
+        }
+        if(m_config.enable_record) {
+            cout << ">>[App] 启动本地录像线程... (" << p->record_dir << ")" << endl;
+            // 启动本地录像线程
+            p->record_thread = new std::thread(&StreamerApp::recordWorker, this, p);
+        }
     }
     if (m_config.enable_stream || m_config.enable_record) {
         cout << ">>[App] 启动音频采集线程..." << endl;
@@ -125,61 +266,64 @@ void StreamerApp::start( ) {
     }
 }
 
+// 等待并释放一个线程
+static void join_thread(std::thread*& t) {
+    if (!t) return;
+    if (t->joinable()) {
+        t->join();
+    }
+    delete t;
+    t = nullptr;
+}
+
 //停止
 void StreamerApp::stop() {
     
-    if (m_camera_fd == -1 && m_net_thread == nullptr) {
+    if (m_pipelines.empty()) {
         return; 
     }
     
     cout << ">>[App] 正在停止..." << endl;
     m_is_running = false;
 
-    // ============================================================
-    // 1. 清理网络推流线程
-    // ============================================================
-    if (m_net_thread) {
-        // A. 唤醒队列阻塞 
-        m_queue.stop();
+    for (CameraPipeline* p : m_pipelines) {
+        // 视频线程 (正常情况下 runMainLoop 已经等它退出了)
+        join_thread(p->video_thread);
 
-        // B. 等待线程退出
-        if (m_net_thread->joinable()) {
-            m_net_thread->join();
-        }
-        delete m_net_thread;
-        m_net_thread = nullptr;
-        cout << ">>[App] 网络线程退出" << endl;
-    }
-    // C. 线程退出后，清理队列里残留的未发送数据 
-    m_queue.clear();
+        // ============================================================
+        // 1. 清理网络推流线程
+        // ============================================================
+        if (p->net_thread) {
+            // A. 唤醒队列阻塞 
+            p->stream_queue.stop();
 
-    // ============================================================
-    // 2. 清理本地录像线程 
-    // ============================================================
-    if (m_record_thread) {
-        // A. 唤醒队列
-        m_record_queue.stop();
-
-        // B. 等待线程 (recordWorker 会执行 file_out.close 保存文件)
-        if (m_record_thread->joinable()) {
-            m_record_thread->join();
+            // B. 等待线程退出
+            join_thread(p->net_thread);
+            cout << ">>[App] 网络线程退出 (cam" << p->id << ")" << endl;
         }
-        delete m_record_thread;
-        m_record_thread = nullptr;
-        cout << ">>[App] 录像线程退出 (文件已封包)" << endl;
+        // C. 线程退出后，清理队列里残留的未发送数据 
+        p->stream_queue.clear();
+
+        // ============================================================
+        // 2. 清理本地录像线程 
+        // ============================================================
+        if (p->record_thread) {
+            // A. 唤醒队列
+            p->record_queue.stop();
+
+            // B. 等待线程 (recordWorker 会执行 file_out.close 保存文件)
+            join_thread(p->record_thread);
+            cout << ">>[App] 录像线程退出 (文件已封包, cam" << p->id << ")" << endl;
+        }
+        // C. 清理残留数据
+        p->record_queue.clear();
     }
-    // C. 清理残留数据
-    m_record_queue.clear();
 
     // ============================================================
     // 3. 清理音频采集线程
     // ============================================================
     if (m_audio_thread) {
-        if (m_audio_thread->joinable()) {
-            m_audio_thread->join();
-        }
-        delete m_audio_thread;
-        m_audio_thread = nullptr;
+        join_thread(m_audio_thread);
         cout << ">>[App] 音频线程退出" << endl;
     };
 
@@ -193,149 +337,279 @@ void StreamerApp::stop() {
 void StreamerApp::releaseResources() {
     cout << ">>[App] 释放资源..." << endl;
 
-    // 释放堆内存
-    if (m_ai_buf) { free(m_ai_buf); m_ai_buf = nullptr; }
-    if (m_draw_buf) { free(m_draw_buf); m_draw_buf = nullptr; }
-
     // 释放 AI
     if (m_detector) { delete m_detector; m_detector = nullptr; }
 
-    // 释放 MPP (要在 V4L2 之前)
-    if (m_encoder) { delete m_encoder; m_encoder = nullptr; }
+    for (CameraPipeline* p : m_pipelines) {
+        // 释放堆内存
+        m_buffer_pool.release(&p->ai_buf);
+        m_buffer_pool.release(&p->preview_buf);
+
+        // 先停视频源 (采集线程归还它手里的帧，然后关流)
+        // DMABUF 模式下驱动队列里还挂着编码器的内存，必须在释放 MPP 之前关流
+        if (p->source) p->source->stop();
 
-    // 释放 V4L2
-    if (m_camera_fd > 0) {
-        stop_capturing(m_camera_fd);
-        release_buffers(m_camera_buffers, m_n_buffers);
+        // 释放 MPP
+        p->encoder.deinit();
 
-        // 归还内核缓冲
-        struct v4l2_requestbuffers req = {0};
-        req.count = 0;
-        req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        req.memory = V4L2_MEMORY_MMAP;
-        ioctl(m_camera_fd, VIDIOC_REQBUFS, &req);
-        close(m_camera_fd);
-        m_camera_fd = -1;
+        // 释放视频源 (V4L2 在这里关闭设备)
+        if (p->source) { delete p->source; p->source = nullptr; }
+        delete p;
     }
+    m_pipelines.clear();
 }
 
-// 主视频循环
+// 主视频循环：每路摄像头一个视频线程，阻塞到全部退出
 void StreamerApp::runMainLoop() {
     cout << ">>[App] 启动主视频循环..." << endl;
 
+    for (CameraPipeline* p : m_pipelines) {
+        p->video_thread = p->passthrough
+                        ? new std::thread(&StreamerApp::passthroughWorker, this, p)
+                        : new std::thread(&StreamerApp::videoWorker, this, p);
+    }
+    for (CameraPipeline* p : m_pipelines) {
+        join_thread(p->video_thread);
+    }
+}
+
+// 一路摄像头的视频循环
+void StreamerApp::videoWorker(CameraPipeline* p) {
+    MppEncoder& encoder = p->encoder;
+    FrameSource& source = *p->source;
+    // 多路时日志前面带上摄像头编号
+    std::string cam_tag = (m_pipelines.size() > 1) ? "[cam" + std::to_string(p->id) + "] " : "";
+    // 检测框直接画在 NV12 上，字形只光栅化一次
+    Nv12Overlay overlay(0.6, 2);
+    const YuvColor box_color = YuvColor::from_rgb(0, 255, 0);
+    // 时间戳水印：黑底白字，一秒才变一次，其余帧直接拷缓存好的亮度块
+    GlyphAtlas watermark_font(1.2, 3);
+    TextPatch watermark(watermark_font, 575, 30, 0, 255);
+    time_t watermark_sec = 0;
+    // 帧金字塔：AI 输入和预览的内存是固定的，编码器那一层每帧设置
+    FramePyramid pyramid;
+    // AI 输入保持宽高比 (letterbox)：源帧等比缩放进 640x640 中间，上下/左右补灰边，
+    // 缩放和补边在同一个 RGA job 里做，边只在第一帧填一次；检测框按同一组参数换算回源帧坐标
+    letterbox_t ai_letterbox = {640, 640, 1.0f, 1.0f, 0, 0};
+    if (m_config.enable_ai) {
+        ai_letterbox = m_detector->make_letterbox(source.get_width(), source.get_height());
+        im_rect ai_region = {ai_letterbox.x_pad, ai_letterbox.y_pad,
+                             ai_letterbox.target_width - 2 * ai_letterbox.x_pad,
+                             ai_letterbox.target_height - 2 * ai_letterbox.y_pad};
+        pyramid.set_level(PYRAMID_AI, {p->ai_buf.ptr, p->ai_buf.fd, 640, 640, 640, 640, RK_FORMAT_RGB_888},
+                          ai_region, 0xFF727272);   // YOLO 训练时的填充色 (114,114,114)
+        // 多路时 RGA 可能忙不过来，AI 那层可以交给 CPU (SIMD) 和 RGA 并行做
+        pyramid.set_cpu_level(PYRAMID_AI, m_config.ai_convert == "cpu");
+    }
+    if (p->preview_buf.ptr) {
+        pyramid.set_level(PYRAMID_PREVIEW, {p->preview_buf.ptr, p->preview_buf.fd,
+                                            m_config.preview_width, m_config.preview_height,
+                                            preview_hor_stride(m_config.preview_width),
+                                            preview_ver_stride(m_config.preview_height),
+                                            RK_FORMAT_YCbCr_420_SP});
+    }
+    // osd_backend = rga 时叠加物改成 RGA 合成的图层：logo/时钟/检测框各一块 RGBA 小图，
+    // 内容变了才用 CPU 重画，每帧一个 RGA job 混合进编码器输入；cpu 时还是上面直接画 NV12
+    std::unique_ptr<OsdCompositor> compositor;
+    OsdLayer* clock_layer = nullptr;
+    OsdLayer* det_layer = nullptr;
+    const OsdColor white = {255, 255, 255, 255}, black = {0, 0, 0, 255}, green = {0, 255, 0, 255};
+    if (m_config.osd_backend == "rga" || m_config.osd_backend == "rga_cpu") {
+        compositor.reset(new OsdCompositor());
+        if (compositor->init(m_config.osd_backend == "rga") == 0) {
+            OsdLayer* logo_layer = compositor->add_layer(0, 0, 124, 30);
+            clock_layer = compositor->add_layer(124, 0, 452, 30);
+            if (m_config.enable_ai) det_layer = compositor->add_layer(0, 0, m_config.width, m_config.height);
+            if (logo_layer) {
+                // logo 不会变，只画一次
+                logo_layer->begin_draw();
+                logo_layer->fill_rect(0, 0, logo_layer->width(), logo_layer->height(), black);
+                logo_layer->draw_text(watermark_font, 0, 25, "NJUPT", white);
+                logo_layer->end_draw();
+            }
+        }
+        if (!clock_layer) {
+            std::cerr << ">>[OSD] " << cam_tag << "图层合成初始化失败，改用 CPU 直接画" << std::endl;
+            compositor.reset();
+        }
+    }
+
     long long last_log_time = get_time_ms();
-    long long start_pts_base = get_time_ms();
+    // PTS 基准：第一帧的采集时刻 (采集在线程启动之前就开始了，不能拿线程启动的时刻当基准，
+    // 否则之前排队的几帧 PTS 全是负的)
+    int64_t start_pts_base = -1;
     int frame_count = 0;
     int total_bytes = 0;
+    // 驱动帧序号，用来发现传感器丢帧
+    bool has_last_seq = false;
+    uint32_t last_sequence = 0;
+    int lost_frames = 0;
+    int idle_waits = 0;
+    uint64_t last_skipped = 0;
 
     
     while (m_is_running) {
-        // 1. 获取 V4L2 帧
-        int index = wait_and_get_frame(m_camera_fd);
-        if (index < 0) continue; // 超时或错误
-
-        int src_fd = m_camera_buffers[index].export_fd; // V4L2 (YUYV)
-        int dst_fd = m_encoder->get_input_fd();         // MPP (NV12)
-        // 获取当前时间字符串
-        std::string time_str = get_current_time_string();
-        // 2. 根据开关处理逻辑
-        if (m_config.enable_ai) {
-            // --- AI 开启模式 ---
-            
-            // A. 转 640x640 RGB 给 AI
-            rga_convert(nullptr, src_fd, m_config.width, m_config.height, m_src_format,
-                       m_ai_buf, -1, 640, 640, RK_FORMAT_RGB_888);
-
-            // B. 推理
-            std::vector<Object> objects = m_detector->detect(m_ai_buf);
-
-            // C. 转 720P RGB 准备画图
-            rga_convert(nullptr, src_fd, m_config.width, m_config.height,  m_src_format,
-                       m_draw_buf, -1, m_config.width, m_config.height, RK_FORMAT_RGB_888);
-
-            // D. OpenCV 画框
-            cv::Mat frame_rgb(m_config.height, m_config.width, CV_8UC3, m_draw_buf);
-            float scale_x = (float)m_config.width / 640.0;
-            float scale_y = (float)m_config.height / 640.0;
-
-            for (auto& obj : objects) {
-                int x = obj.x * scale_x;
-                int y = obj.y * scale_y;
-                int w = obj.w * scale_x;
-                int h = obj.h * scale_y;
-                
-                // 简单边界保护
-                x = std::max(0, x); y = std::max(0, y);
-                if (x + w > m_config.width) w = m_config.width - x;
-                if (y + h > m_config.height) h = m_config.height - y;
+        // 1. 从视频源取最新一帧 (带采集时间戳和帧序号)
+        //    短超时，方便及时响应退出信号
+        SourceFrame frame;
+        if (!source.acquire(&frame, 100)) {
+            if (++idle_waits == 20) {
+                std::cerr << ">>[Source] 等待帧超时 (Timeout): " << source.get_name() << std::endl;
+            }
+            continue;
+        }
+        idle_waits = 0;
+        const FrameInfo& frame_info = frame.info;
+        int index = frame.index;
+
+        // 帧序号往前跳 = 驱动丢帧，或者采集线程替换掉了没来得及处理的旧帧
+        // 序号回退/重新开始 (驱动重启) 不算丢帧，从这一帧重新对齐
+        int32_t seq_gap = (int32_t)(frame_info.sequence - last_sequence);
+        if (has_last_seq && seq_gap > 1) {
+            lost_frames += seq_gap - 1;
+        }
+        last_sequence = frame_info.sequence;
+        has_last_seq = true;
+
+        // PTS 取采集时刻，而不是编码完成的时刻，编码耗时抖动不会影响时间戳
+        if (start_pts_base < 0) start_pts_base = frame_info.timestamp_us / 1000;
+        int64_t pts = frame_info.timestamp_us / 1000 - start_pts_base;
+
+        // 零拷贝模式下摄像头已经写进了编码器输入池，直接在上面叠水印、编码
+        // 文件回放/合成源没有 dma-buf，RGA 走虚拟地址 (src_ptr)
+        // 源分辨率可能和编码分辨率不一样 (协商到了更大的模式)，由 RGA 顺便缩放
+        // MJPEG 解码出来的帧带对齐 (1080p 是 1920x1088)，RGA 按 stride 读
+        void* src_ptr = frame.virt;
+        int src_w = source.get_width();
+        int src_h = source.get_height();
+        int src_ws = frame.hor_stride;
+        int src_hs = frame.ver_stride;
+        int src_fmt = frame.format;
+        int src_fd = p->zero_copy ? -1 : frame.dma_fd; // V4L2 (YUYV) / MJPEG 解码输出
+        int dst_fd = p->zero_copy ? encoder.get_pool_fd(index)
+                                 : encoder.get_input_fd();               // MPP (NV12)
+
+        // 2. 帧金字塔：编码器 NV12 / AI RGB / 预览，一个 RGA job 读一次源帧全部生成
+        //    异步提交，RGA 干活的时候 CPU 去更新时钟图层，然后再等结果
+        //    零拷贝模式下摄像头已经写进了编码器输入，只剩预览要从它缩出来
+        bool pyramid_submitted = false;
+        if (p->zero_copy) {
+            if (pyramid.has_level(PYRAMID_PREVIEW)) {
+                RgaImage enc_img = {encoder.get_pool_ptr(index), dst_fd, m_config.width, m_config.height,
+                                    encoder.get_hor_stride(), encoder.get_ver_stride(), RK_FORMAT_YCbCr_420_SP};
+                pyramid.submit(enc_img, frame_info.sequence);
+                pyramid_submitted = true;
+            }
+        } else {
+            RgaImage src_img = {src_ptr, src_fd, src_w, src_h, src_ws, src_hs, src_fmt};
+            pyramid.set_level(PYRAMID_ENCODER, {encoder.get_input_ptr(), dst_fd, m_config.width, m_config.height,
+                                                encoder.get_hor_stride(), encoder.get_ver_stride(),
+                                                RK_FORMAT_YCbCr_420_SP});
+            pyramid.submit(src_img, frame_info.sequence);
+            pyramid_submitted = true;
+        }
 
-                cv::rectangle(frame_rgb, cv::Rect(x, y, w, h), cv::Scalar(0, 255, 0), 2);
-                
-                // 显示 Label
-                string label = obj.label + " " + to_string(obj.prob).substr(0, 3);
-                cv::putText(frame_rgb, label, cv::Point(x, y - 5), 
-                            cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 255, 0), 2);
+        // 时间字符串一秒才变一次，换秒的时候才重新格式化、重新合成水印
+        time_t now_sec = time(nullptr);
+        if (now_sec != watermark_sec) {
+            watermark_sec = now_sec;
+            if (compositor) {
+                clock_layer->begin_draw();
+                clock_layer->clear();
+                clock_layer->fill_rect(0, 0, clock_layer->width(), clock_layer->height(), black);
+                clock_layer->draw_text(watermark_font, 1, 25, get_current_time_string(), white);
+                clock_layer->end_draw();
+            } else {
+                watermark.update({{0, "NJUPT"}, {125, get_current_time_string()}}, 25);
             }
+        }
 
-            // E. RGB 转回 NV12 给编码器
-            rga_convert(m_draw_buf, -1, m_config.width, m_config.height, RK_FORMAT_RGB_888,
-                       nullptr, dst_fd, m_config.width, m_config.height, RK_FORMAT_YCbCr_420_SP);
+        if (pyramid_submitted) pyramid.wait();
+        // 源帧已经用完，马上还给驱动 (不用等推理和编码)
+        if (!p->zero_copy) source.release(index);
 
-        } else {
-  
-            rga_convert(nullptr, src_fd, m_config.width, m_config.height, m_src_format,
-                       nullptr, dst_fd,m_config.width, m_config.height, RK_FORMAT_YCbCr_420_SP);
- 
+        // A. 推理 (读金字塔里的 640x640 RGB，框是源帧坐标)
+        std::vector<Object> objects;
+        if (pyramid.has_level(PYRAMID_AI)) {
+            const RgaImage& ai_img = pyramid.level(PYRAMID_AI);
+            std::lock_guard<std::mutex> lock(m_detector_mtx);
+            objects = m_detector->detect(ai_img.ptr, ai_img.fd, &ai_letterbox);
         }
 
-        void* dst_ptr = mmap(NULL, m_config.width * m_config.height * 1.5, 
-                                 PROT_READ | PROT_WRITE, MAP_SHARED, dst_fd, 0);
-
-        if (dst_ptr != MAP_FAILED) {
-                // 3. 把 NV12 的 Y 平面当做灰度图
-                // NV12 的前 w*h 个字节就是亮度信息，可以当 CV_8UC1 处理
-                cv::Mat y_plane(m_config.height, m_config.width, CV_8UC1, dst_ptr);
-
-                // 画灰度水印
-                // Scalar(0) 是黑色，Scalar(255) 是白色
-                cv::rectangle(y_plane, cv::Rect(0, 0, 575, 30), 
-                              cv::Scalar(0), cv::FILLED); // 黑色背景
-                //cv::putText(y_plane, time_str, cv::Point(0, 25), 
-                //            cv::FONT_HERSHEY_SIMPLEX, 1.2, cv::Scalar(0), 4);   // 黑边
-                cv::putText(y_plane, "NJUPT", cv::Point(0, 25), 
-                            cv::FONT_HERSHEY_SIMPLEX, 1.2, cv::Scalar(255), 3); // 白字
-                cv::putText(y_plane, time_str, cv::Point(125, 25), 
-                            cv::FONT_HERSHEY_SIMPLEX, 1.2, cv::Scalar(255), 3); // 白字
-
-                // 4. 解除映射 (部分 CPU 需要这一步来同步 Cache)
-                munmap(dst_ptr, m_config.width * m_config.height * 1.5);
-        }
-        // 3. 归还 V4L2 帧
-        return_frame(m_camera_fd, index);
+        // 编码器输入内存是常驻映射 (MPP 分配时就映射好了)，不用每帧 mmap/munmap
+        // CPU 画水印前后用 DMA_BUF_IOCTL_SYNC 包起来：先看到 RGA/摄像头写的内容，画完刷给 MPP
+        void* dst_ptr = p->zero_copy ? encoder.get_pool_ptr(index) : encoder.get_input_ptr();
+
+        // C. 检测框和标签 (坐标从源帧换算到编码分辨率)
+        Nv12Image nv12 = {(uint8_t*)dst_ptr, m_config.width, m_config.height,
+                          encoder.get_hor_stride(), encoder.get_ver_stride()};
+        float scale_x = (float)m_config.width / src_w;
+        float scale_y = (float)m_config.height / src_h;
+        const GlyphAtlas& label_font = overlay.glyphs();
+
+        if (compositor) {
+            // 检测框画进自己的图层 (只清上一帧画过的地方)，然后所有图层一次 RGA 混合进帧
+            if (det_layer) {
+                det_layer->begin_draw();
+                det_layer->clear();
+                for (auto& obj : objects) {
+                    int x = obj.x * scale_x;
+                    int y = obj.y * scale_y;
+                    det_layer->draw_rect(x, y, obj.w * scale_x, obj.h * scale_y, green, 2);
+                    string label = obj.label + " " + to_string(obj.prob).substr(0, 3);
+                    int baseline = std::max(y - 5, label_font.ascent());
+                    det_layer->draw_text(label_font, std::max(x, 0), baseline, label, green);
+                }
+                det_layer->end_draw();
+            }
+            compositor->compose(dst_fd, nv12);
+        } else if (dst_ptr) {
+                DmaBufCpuAccess cpu_access(dst_fd);
+
+                for (auto& obj : objects) {
+                    int x = obj.x * scale_x;
+                    int y = obj.y * scale_y;
+                    int w = obj.w * scale_x;
+                    int h = obj.h * scale_y;
+
+                    overlay.draw_rect(nv12, x, y, w, h, box_color, 2);
+
+                    // 显示 Label (框贴着顶边时画到框里面)
+                    string label = obj.label + " " + to_string(obj.prob).substr(0, 3);
+                    int baseline = std::max(y - 5, label_font.ascent());
+                    overlay.draw_text(nv12, std::max(x, 0), baseline, label, box_color);
+                }
 
+                // 3. 时间戳水印 (按行拷贝缓存好的亮度块)
+                watermark.blit(nv12, 0, 0);
+
+                // 4. 出作用域时 sync end，把 CPU 写的数据刷给编码器
+        }
+        // 3. 零拷贝模式要等编码完再还 V4L2 帧，编码器还在读这块内存
         // 4. MPP 编码
-        void* enc_data = nullptr; size_t enc_len = 0; bool is_key = false;
+        PacketBuffer enc_data; size_t enc_len = 0; bool is_key = false;
+        int enc_ret = p->zero_copy
+                    ? encoder.encode_pool_to_memory(index, &enc_data, &enc_len, &is_key)
+                    : encoder.encode_to_memory(&enc_data, &enc_len, &is_key);
+        if (p->zero_copy) source.release(index);
+
+        if (enc_ret == 0) {
+            // 编码结果只分配一次，推流和录像队列共享同一份引用
+            MediaPacket pkt;
+            pkt.buffer = enc_data;
+            pkt.size = enc_len;
+            pkt.timestamp = (uint32_t)pts;
+            pkt.is_keyframe = is_key;
+            pkt.type = MEDIA_VIDEO;
 
-        if (m_encoder->encode_to_memory(&enc_data, &enc_len, &is_key) == 0) {
-            long long pts = get_time_ms() - start_pts_base;
             //  分支 A: 处理推流 
             if (m_config.enable_stream) {
-                // 必须 malloc 复制一份，因为 enc_data 下一帧会被覆盖
-                void* data_net = malloc(enc_len);
-                if (data_net) {
-                    memcpy(data_net, enc_data, enc_len);
-                    m_queue.push(data_net, enc_len, pts, is_key, MEDIA_VIDEO);
-                }
+                p->stream_queue.push(pkt);
             }
 
             //  分支 B: 处理录像 
             if (m_config.enable_record) {
-                // 必须再 malloc 复制一份，这是给录像线程专用的
-                void* data_rec = malloc(enc_len);
-                if (data_rec) {
-                    memcpy(data_rec, enc_data, enc_len);
-                    m_record_queue.push(data_rec, enc_len, pts, is_key, MEDIA_VIDEO);
-                }
+                p->record_queue.push(pkt);
             }
             frame_count++;
             total_bytes += enc_len;
@@ -347,7 +621,7 @@ void StreamerApp::runMainLoop() {
             float bitrate_kbps = (total_bytes * 8.0) / 1000.0;
             
             // 构建动态状态字符串
-            std::string status_str = "";
+            std::string status_str = cam_tag;
             
             // 检查推流
             if (m_config.enable_stream) status_str += "[SRT:ON] ";
@@ -361,22 +635,157 @@ void StreamerApp::runMainLoop() {
             if (m_config.enable_ai)     status_str += "[AI:ON]";
             else                        status_str += "[AI:--]";
 
+            if (p->zero_copy)            status_str += " [ZC]";
+
             
-            printf(">> %s | 帧率: %d | 码率: %.2f Kbps\n", 
+            // 采集丢帧里有多少是处理太慢被跳过的
+            uint64_t skipped = source.get_skipped();
+            printf(">> %s | 帧率: %d | 码率: %.2f Kbps | 采集丢帧: %d (处理跳帧: %llu)\n", 
                    status_str.c_str(), 
                    frame_count, 
-                   bitrate_kbps);
+                   bitrate_kbps,
+                   lost_frames,
+                   (unsigned long long)(skipped - last_skipped));
+            last_skipped = skipped;
+
+            // 队列水位：用来调 StreamQueue/RecordQueue 的预算，丢帧之前就能看到积压
+            if (m_config.enable_stream) printQueueStats((cam_tag + "StreamQueue").c_str(), p->stream_queue.stats());
+            if (m_config.enable_record) printQueueStats((cam_tag + "RecordQueue").c_str(), p->record_queue.stats());
+            // RGA 句柄缓存是全局的，只让主摄像头打印；稳定运行时未命中应该不再增长
+            if (p->id == 0) {
+                RgaCacheStats rga_stats = rga_cache_stats();
+                printf(">>[RGA] 句柄缓存: 命中 %llu | 未命中 %llu | 淘汰 %llu | 句柄数 %zu\n",
+                       (unsigned long long)rga_stats.hits, (unsigned long long)rga_stats.misses,
+                       (unsigned long long)rga_stats.evictions, rga_stats.entries);
+            }
             last_log_time = now;
             frame_count = 0;
             total_bytes = 0;
+            lost_frames = 0;
         }
     }
 }
 
+// H.264 直通：摄像头出来的每一帧码流原样入队，不经过 RGA 和编码器
+// 关键帧靠扫 NAL 类型判断；开头和丢帧之后要等到下一个 IDR 才开始发，否则解码端会花屏
+void StreamerApp::passthroughWorker(CameraPipeline* p) {
+    FrameSource& source = *p->source;
+    std::string cam_tag = (m_pipelines.size() > 1) ? "[cam" + std::to_string(p->id) + "] " : "";
+
+    long long last_log_time = get_time_ms();
+    int64_t start_pts_base = -1;   // 第一帧的采集时刻，同 videoWorker
+    int frame_count = 0;
+    int total_bytes = 0;
+    bool has_last_seq = false;
+    uint32_t last_sequence = 0;
+    int lost_frames = 0;
+    int waiting_frames = 0;   // 等 IDR 期间扔掉的帧
+    int idle_waits = 0;
+
+    H264ParamSets params;
+    bool need_idr = true;
+
+    while (m_is_running) {
+        // 1. 按顺序取下一帧码流
+        SourceFrame frame;
+        if (!source.acquire(&frame, 100)) {
+            if (++idle_waits == 20) {
+                std::cerr << ">>[Source] 等待帧超时 (Timeout): " << source.get_name() << std::endl;
+            }
+            continue;
+        }
+        idle_waits = 0;
+
+        // 驱动丢了帧 (或者序号重新开始)，参考链断了，等下一个 IDR；只有往前跳才算丢帧
+        int32_t seq_gap = (int32_t)(frame.info.sequence - last_sequence);
+        if (has_last_seq && seq_gap != 1) {
+            if (seq_gap > 1) lost_frames += seq_gap - 1;
+            need_idr = true;
+        }
+        last_sequence = frame.info.sequence;
+        has_last_seq = true;
+
+        if (start_pts_base < 0) start_pts_base = frame.info.timestamp_us / 1000;
+        int64_t pts = frame.info.timestamp_us / 1000 - start_pts_base;
+
+        // 2. 看看这一帧里有哪些 NAL
+        const uint8_t* data = (const uint8_t*)frame.virt;
+        H264AuInfo au;
+        if (!data || frame.size == 0 || !h264_scan_au(data, frame.size, &au)) {
+            source.release(frame.index);
+            continue;
+        }
+        if (au.has_sps || au.has_pps) params.update(data, frame.size);
+
+        if (need_idr && !au.has_idr) {
+            source.release(frame.index);
+            waiting_frames++;
+            continue;
+        }
+        need_idr = false;
+
+        // 3. 拷出来 (V4L2 buffer 要马上还给驱动)
+        //    IDR 前面没带 SPS/PPS 的，补上最近一次的，录像切片和新连接才能从这一帧开始解
+        size_t header = (au.has_idr && !au.has_sps) ? params.header_size() : 0;
+        size_t len = header + frame.size;
+        std::shared_ptr<uint8_t> buf = alloc_packet_buffer(len);
+        if (buf) {
+            // buf 只多留了 header 字节，不需要补头的帧 (P 帧、自带 SPS 的 IDR) 不能写
+            if (header) params.write_header(buf.get());
+            memcpy(buf.get() + header, data, frame.size);
+        }
+        source.release(frame.index);
+        if (!buf) continue;
+
+        MediaPacket pkt;
+        pkt.buffer = buf;
+        pkt.size = len;
+        pkt.timestamp = (uint32_t)pts;
+        pkt.is_keyframe = au.has_idr;
+        pkt.type = MEDIA_VIDEO;
+        if (m_config.enable_stream) p->stream_queue.push(pkt);
+        if (m_config.enable_record) p->record_queue.push(pkt);
+        frame_count++;
+        total_bytes += len;
+
+        // 4. 打印状态
+        long long now = get_time_ms();
+        if (now - last_log_time >= 1000) {
+            std::string status_str = cam_tag;
+            status_str += m_config.enable_stream ? "[SRT:ON] " : "[SRT:--] ";
+            status_str += m_config.enable_record ? "[REC:ON] " : "[REC:--] ";
+            status_str += "[H264 直通]";
+            printf(">> %s | 帧率: %d | 码率: %.2f Kbps | 采集丢帧: %d (等 IDR 丢弃: %d)\n",
+                   status_str.c_str(), frame_count, (total_bytes * 8.0) / 1000.0,
+                   lost_frames, waiting_frames);
+
+            if (m_config.enable_stream) printQueueStats((cam_tag + "StreamQueue").c_str(), p->stream_queue.stats());
+            if (m_config.enable_record) printQueueStats((cam_tag + "RecordQueue").c_str(), p->record_queue.stats());
+            last_log_time = now;
+            frame_count = 0;
+            total_bytes = 0;
+            lost_frames = 0;
+            waiting_frames = 0;
+        }
+    }
+}
+
+// 打印一行队列统计
+void StreamerApp::printQueueStats(const char* name, const QueueStats& st) {
+    printf(">>   %s | 深度: %zu视频/%zu音频 (峰值 %zu) | 缓存: %zuKB (峰值 %zuKB) | "
+           "等待: 平均 %.1fms 最大 %.1fms | 丢弃: I帧 %llu P帧 %llu 音频 %llu\n",
+           name, st.video_depth, st.audio_depth, st.depth_high_water,
+           st.bytes_in_flight / 1024, st.bytes_high_water / 1024,
+           st.wait_avg_ms(), st.wait_max_us / 1000.0,
+           (unsigned long long)st.dropped_video_key,
+           (unsigned long long)st.dropped_video,
+           (unsigned long long)st.dropped_audio);
+}
+
 //网络线程
-void StreamerApp::networkWorker() {
+void StreamerApp::networkWorker(CameraPipeline* p) {
     SrtPusher pusher;
-    if (pusher.connect(m_config.ip, m_config.port, m_config.stream_id) < 0) {
+    if (pusher.connect(m_config.ip, m_config.port, p->stream_id) < 0) {
         cerr << ">>[SRT] 连接失败，网络线程退出" << endl;
         return;
     }
@@ -385,16 +794,19 @@ void StreamerApp::networkWorker() {
     auto send_cb = [&](void* d, int l) { return pusher.send(d, l); };
     muxer.init(m_config.width, m_config.height, m_config.fps, 44100, 2, send_cb);
 
-    MediaPacket pkt;
+    // 一次取走队列里所有的包，减少加锁/唤醒次数；超时后回来检查运行标志
+    std::vector<MediaPacket> batch;
     while (m_is_running) {
-        if (m_queue.pop(pkt)) { // 阻塞等待
+        if (p->stream_queue.pop_batch(batch, QUEUE_BATCH_SIZE, QUEUE_POP_TIMEOUT) == 0) continue;
+
+        for (const MediaPacket& pkt : batch) {
             if (pkt.type == MEDIA_VIDEO) {
-                muxer.write_video(pkt.data, pkt.size, pkt.timestamp, pkt.is_keyframe);
+                muxer.write_video(pkt.data(), pkt.size, pkt.timestamp, pkt.is_keyframe);
             } else if (pkt.type == MEDIA_AUDIO) {
-                muxer.write_audio(pkt.data, pkt.size, pkt.timestamp);
+                muxer.write_audio(pkt.data(), pkt.size, pkt.timestamp);
             }
-            free(pkt.data); // 释放内存
         }
+        batch.clear(); // 尽早归还引用
     }
     // 退出清理
     muxer.close();
@@ -424,22 +836,22 @@ void StreamerApp::audioWorker() {
             if (len > 0) {
                 uint32_t pts = (uint32_t)(total_samples * 1000 / 44100);
                 total_samples += 1024;
-                if (m_config.enable_stream) {
-                void* d = malloc(len);
-                memcpy(d, aac_buf.data(), len);
-                m_queue.push(d, len, pts, false, MEDIA_AUDIO);
-                }
-                if (m_config.enable_record) {
-                void* d = malloc(len);
-                memcpy(d, aac_buf.data(), len);
-                m_record_queue.push(d, len, pts, false, MEDIA_AUDIO);
+                // 拷贝一次，所有摄像头的队列共享
+                MediaPacket pkt = make_media_packet(aac_buf.data(), len, pts, false, MEDIA_AUDIO);
+                for (CameraPipeline* p : m_pipelines) {
+                    if (m_config.enable_stream) {
+                        p->stream_queue.push(pkt);
+                    }
+                    if (m_config.enable_record) {
+                        p->record_queue.push(pkt);
+                    }
                 }
             }
         }
     }
 }
 
-void StreamerApp::recordWorker() {
+void StreamerApp::recordWorker(CameraPipeline* p) {
     TsMuxer muxer;
     std::ofstream file_out;
     std::string current_file_path;
@@ -460,14 +872,16 @@ void StreamerApp::recordWorker() {
     // 使用 m_config 中的参数
     muxer.init(m_config.width, m_config.height, m_config.fps, 44100, 2, write_callback);
 
-    MediaPacket pkt;
     printf(">>[REC] 录像线程启动 | 存储目录: %s/ | 分段: %d分钟\n", 
-           m_config.record_dir.c_str(), m_config.segment_ms / 60000);
+           p->record_dir.c_str(), m_config.segment_ms / 60000);
     printf(">>[REC] 等待关键帧(I-Frame)以开始录制...\n");
 
+    std::vector<MediaPacket> batch;
     while (m_is_running) {
-        // 从录像队列取出数据包
-        if (m_record_queue.pop(pkt)) {
+        // 从录像队列一次取出所有数据包，队列为空时阻塞等待 (超时后回来检查运行标志)
+        if (p->record_queue.pop_batch(batch, QUEUE_BATCH_SIZE, QUEUE_POP_TIMEOUT) == 0) continue;
+
+        for (const MediaPacket& pkt : batch) {
             long long now = get_time_ms();
 
             // =========================================================
@@ -488,11 +902,11 @@ void StreamerApp::recordWorker() {
             // 必须由关键帧开始，否则播放器会花屏或报错
             if (!file_out.is_open()) {
                 if (pkt.is_keyframe) {
-                    current_file_path = generateFileName();
-                    
+                    current_file_path = generateFileName(p->record_dir);
+                
                     if (!current_file_path.empty()) {
                         file_out.open(current_file_path, std::ios::binary);
-                        
+                    
                         if (file_out.is_open()) {
                             last_segment_time = now;
                             printf(">>[REC] 开始录制新文件: %s\n", current_file_path.c_str());
@@ -503,7 +917,6 @@ void StreamerApp::recordWorker() {
                 } else {
                     // 如果文件没开，且当前帧不是关键帧，这帧数据必须丢弃
                     // printf(">>[REC] 丢弃非关键帧...\n");
-                    free(pkt.data);
                     continue; // 跳过后续写入
                 }
             }
@@ -513,19 +926,15 @@ void StreamerApp::recordWorker() {
             // =========================================================
             if (file_out.is_open()) {
                 if (pkt.type == MEDIA_VIDEO) {
-                    muxer.write_video(pkt.data, pkt.size, pkt.timestamp, pkt.is_keyframe);
+                    muxer.write_video(pkt.data(), pkt.size, pkt.timestamp, pkt.is_keyframe);
                 } else if (pkt.type == MEDIA_AUDIO) {
-                    muxer.write_audio(pkt.data, pkt.size, pkt.timestamp);
+                    muxer.write_audio(pkt.data(), pkt.size, pkt.timestamp);
                 }
             }
-
-            // 重要：消费完队列里的数据后，必须释放内存
-            // 这个 malloc 是在 runMainLoop 里分配的
-            free(pkt.data);
-        } else {
-            // 队列为空，短暂休眠避免空转
-            std::this_thread::sleep_for(std::chrono::milliseconds(5));
         }
+
+        // 消费完后放掉引用，推流队列也释放后内存自动回收
+        batch.clear();
     }
 
     // --- 退出清理 ---
@@ -536,40 +945,47 @@ void StreamerApp::recordWorker() {
     muxer.close();
     
     // 清理队列中剩余未处理的包，防止内存泄漏
-    m_record_queue.clear();
+    p->record_queue.clear();
+}
+
+// 创建目录 (0777 表示最高权限，允许读写执行)
+// 已经存在也算成功：多路录像线程会同时来建同一个根目录/日期目录，先检查再 mkdir 会有一个输掉
+static bool ensure_dir(const std::string& dir) {
+    return mkdir(dir.c_str(), 0777) == 0 || errno == EEXIST;
 }
 
 // 辅助函数：生成文件名并自动创建目录
 // 格式：video/20260116/183005.ts
-std::string StreamerApp::generateFileName() {
-    // 1. 获取当前时间
+std::string StreamerApp::generateFileName(const std::string& record_dir) {
+    // 1. 获取当前时间 (多个录像线程同时调用，用 localtime_r)
     std::time_t t = std::time(nullptr);
-    std::tm* now = std::localtime(&t);
+    std::tm tm_now;
+    localtime_r(&t, &tm_now);
+    const std::tm* now = &tm_now;
 
-    char path_buf[256];
-    
     // 2. 检查并创建根目录 (从 m_config 读取)
-    if (access(m_config.record_dir.c_str(), F_OK) == -1) {
-        // 0777 表示最高权限，允许读写执行
-        if (mkdir(m_config.record_dir.c_str(), 0777) != 0) {
-            perror(">>[REC] 创建根目录失败");
-            return ""; 
-        }
+    if (!ensure_dir(m_config.record_dir)) {
+        perror(">>[REC] 创建根目录失败");
+        return "";
+    }
+
+    // 2.1 多路时每路摄像头一个子目录 (例如: video/cam1)
+    if (record_dir != m_config.record_dir && !ensure_dir(record_dir)) {
+        perror(">>[REC] 创建摄像头目录失败");
+        return "";
     }
 
     // 3. 生成日期子目录 (例如: video/20260116)
     // %Y=年, %m=月, %d=日
-    std::string date_dir = m_config.record_dir + "/";
+    std::string date_dir = record_dir + "/";
     char date_str[32];
     strftime(date_str, sizeof(date_str), "%Y%m%d", now);
     date_dir += date_str;
 
     // 4. 检查并创建日期子目录
-    if (access(date_dir.c_str(), F_OK) == -1) {
-        if (mkdir(date_dir.c_str(), 0777) != 0) {
-            perror(">>[REC] 创建日期目录失败");
-            return "";
-        }
+    if (!ensure_dir(date_dir)) {
+        perror(">>[REC] 创建日期目录失败");
+        return "";
     }
 
     // 5. 生成最终文件名 (例如: 183005.ts)
@@ -66,11 +66,11 @@ int TsMuxer::init(int width, int height, int fps, int sample_rate, int channels,
     return 0;
 }
 // 视频写入函数
-int TsMuxer::write_video(void* data, int size, uint32_t timestamp, bool is_key) {
+int TsMuxer::write_video(const void* data, int size, uint32_t timestamp, bool is_key) {
     if (!fmt_ctx || !video_stream) return -1;
 
     AVPacket* pkt = av_packet_alloc();
-    uint8_t* p_data = (uint8_t*)data;
+    const uint8_t* p_data = (const uint8_t*)data;
     
     // 检测 Start Code (H.264 Annex-B)
     bool has_start_code = (size > 4 && p_data[0] == 0 && p_data[1] == 0 && p_data[2] == 0 && p_data[3] == 1);
@@ -101,7 +101,7 @@ int TsMuxer::write_video(void* data, int size, uint32_t timestamp, bool is_key)
 }
 
 // 音频写入函数
-int TsMuxer::write_audio(void* data, int size, uint32_t timestamp) {
+int TsMuxer::write_audio(const void* data, int size, uint32_t timestamp) {
     if (!fmt_ctx || !audio_stream) return -1;
 
     AVPacket* pkt = av_packet_alloc();
@@ -0,0 +1,165 @@
+#include "osd/nv12_overlay.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstring>
+
+static const int FONT_FACE = cv::FONT_HERSHEY_SIMPLEX;
+
+static inline uint8_t clamp_u8(int v) {
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+YuvColor YuvColor::from_rgb(int r, int g, int b) {
+    // BT.601 limited range (定点，系数放大 256 倍)
+    YuvColor c;
+    c.y = clamp_u8(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    c.u = clamp_u8(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    c.v = clamp_u8(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    return c;
+}
+
+// ---------------------------------------------------------------- GlyphAtlas
+
+GlyphAtlas::GlyphAtlas(double font_scale, int thickness)
+    : thickness_(thickness) {
+    // 所有字形共用一套上下沿，排版时基线对齐
+    int base = 0;
+    cv::Size sz = cv::getTextSize("Ayg|", FONT_FACE, font_scale, thickness, &base);
+    ascent_ = sz.height;
+    descent_ = base;
+
+    // 1. 量每个字符的尺寸，排出每个字形在图集里的位置
+    //    getTextSize 的宽度 = 步进 + 线宽；笔画左右各伸出半个线宽
+    int pad = (thickness + 1) / 2;
+    int height = ascent_ + descent_ + 2 * pad;
+    int offsets[95];
+    int atlas_width = 0;
+    for (int i = 0; i < 95; ++i) {
+        std::string s(1, (char)(' ' + i));
+        cv::Size cs = cv::getTextSize(s, FONT_FACE, font_scale, thickness, &base);
+        Glyph& g = glyphs_[i];
+        g.advance = std::max(cs.width - thickness, 0);
+        g.left = pad;
+        g.width = cs.width + pad;
+        g.height = height;
+        g.baseline = ascent_ + pad;
+        offsets[i] = atlas_width;
+        atlas_width += g.width;
+    }
+
+    // 2. 整张图集一次画完
+    cv::Mat atlas(height, atlas_width, CV_8UC1, cv::Scalar(0));
+    for (int i = 0; i < 95; ++i) {
+        std::string s(1, (char)(' ' + i));
+        // 每个字形画在自己的子图里，笔画伸出去的部分会被裁掉，不会压到隔壁
+        cv::Mat cell = atlas(cv::Rect(offsets[i], 0, glyphs_[i].width, height));
+        cv::putText(cell, s, cv::Point(glyphs_[i].left, glyphs_[i].baseline), FONT_FACE,
+                    font_scale, cv::Scalar(255), thickness, cv::LINE_AA);
+    }
+    atlas_.assign(atlas.data, atlas.data + (size_t)atlas_width * height);
+
+    for (int i = 0; i < 95; ++i) {
+        glyphs_[i].mask = atlas_.data() + offsets[i];
+        glyphs_[i].stride = atlas_width;
+    }
+}
+
+const Glyph& GlyphAtlas::get(char c) const {
+    if (c < ' ' || c > '~') c = '?';
+    return glyphs_[c - ' '];
+}
+
+int GlyphAtlas::text_width(const std::string& text) const {
+    int w = 0;
+    for (char c : text) w += get(c).advance;
+    return w + thickness_;
+}
+
+// ---------------------------------------------------------------- Nv12Overlay
+
+Nv12Overlay::Nv12Overlay(double font_scale, int thickness)
+    : glyphs_(font_scale, thickness) {}
+
+void Nv12Overlay::fill_rect(const Nv12Image& img, int x, int y, int w, int h, const YuvColor& color) {
+    // 裁到图像范围内
+    int x0 = std::max(x, 0), y0 = std::max(y, 0);
+    int x1 = std::min(x + w, img.width), y1 = std::min(y + h, img.height);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    // Y：逐行 memset
+    for (int row = y0; row < y1; ++row) {
+        memset(img.y_row(row) + x0, color.y, x1 - x0);
+    }
+
+    // UV：覆盖到的 2x2 块都写上色度
+    for (int row = y0 & ~1; row < y1; row += 2) {
+        uint8_t* uv = img.uv_row(row);
+        for (int col = x0 & ~1; col < x1; col += 2) {
+            uv[col] = color.u;
+            uv[col + 1] = color.v;
+        }
+    }
+}
+
+void Nv12Overlay::draw_rect(const Nv12Image& img, int x, int y, int w, int h,
+                            const YuvColor& color, int thickness) {
+    // 线宽按偶数算，边框正好落在完整的 UV 块上，不会出现半格色边
+    int t = std::max(2, (thickness + 1) & ~1);
+    if (w <= 2 * t || h <= 2 * t) {
+        fill_rect(img, x, y, w, h, color);
+        return;
+    }
+    fill_rect(img, x, y, w, t, color);             // 上
+    fill_rect(img, x, y + h - t, w, t, color);     // 下
+    fill_rect(img, x, y + t, t, h - 2 * t, color); // 左
+    fill_rect(img, x + w - t, y + t, t, h - 2 * t, color); // 右
+}
+
+void Nv12Overlay::draw_text(const Nv12Image& img, int x, int baseline,
+                            const std::string& text, const YuvColor& color) {
+    int pen = x;
+    for (char c : text) {
+        const Glyph& g = glyphs_.get(c);
+        blit_glyph(img, pen - g.left, baseline - g.baseline, g, color);
+        pen += g.advance;
+        if (pen >= img.width) break;
+    }
+}
+
+void Nv12Overlay::blit_glyph(const Nv12Image& img, int x, int top, const Glyph& g, const YuvColor& color) {
+    int x0 = std::max(x, 0), y0 = std::max(top, 0);
+    int x1 = std::min(x + g.width, img.width), y1 = std::min(top + g.height, img.height);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    // Y：按覆盖程度混合，抗锯齿的边缘才不发虚
+    for (int row = y0; row < y1; ++row) {
+        const uint8_t* m = g.mask + (size_t)(row - top) * g.stride;
+        uint8_t* py = img.y_row(row);
+        for (int col = x0; col < x1; ++col) {
+            int a = m[col - x];
+            if (a == 0) continue;
+            py[col] = (uint8_t)((a * color.y + (255 - a) * py[col] + 127) / 255);
+        }
+    }
+
+    // UV：2x2 块里覆盖过半才写色度 (色度分辨率只有一半，做不了混合)
+    for (int row = y0 & ~1; row < y1; row += 2) {
+        uint8_t* uv = img.uv_row(row);
+        for (int col = x0 & ~1; col < x1; col += 2) {
+            int sum = 0;
+            for (int dy = 0; dy < 2; ++dy) {
+                int gy = row + dy - top;
+                if (gy < 0 || gy >= g.height) continue;
+                for (int dx = 0; dx < 2; ++dx) {
+                    int gx = col + dx - x;
+                    if (gx < 0 || gx >= g.width) continue;
+                    sum += g.mask[(size_t)gy * g.stride + gx];
+                }
+            }
+            if (sum >= 2 * 255) {
+                uv[col] = color.u;
+                uv[col + 1] = color.v;
+            }
+        }
+    }
+}
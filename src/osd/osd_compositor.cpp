@@ -0,0 +1,295 @@
+#include "osd/osd_compositor.h"
+#include "video/rga.h"
+#include "video/rga_job.h"
+#include "video/dma_buf.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+// ---------------------------------------------------------------- 像素工具
+
+// 非预乘 src-over：d = c(alpha a) over d
+static inline void blend_rgba(uint8_t* d, const OsdColor& c, int a) {
+    if (a <= 0) return;
+    if (a >= 255 || d[3] == 0) {
+        d[0] = c.r; d[1] = c.g; d[2] = c.b; d[3] = (uint8_t)std::min(a, 255);
+        return;
+    }
+    int da = d[3] * (255 - a) / 255;   // 底下那层还剩多少
+    int oa = a + da;
+    d[0] = (uint8_t)((c.r * a + d[0] * da) / oa);
+    d[1] = (uint8_t)((c.g * a + d[1] * da) / oa);
+    d[2] = (uint8_t)((c.b * a + d[2] * da) / oa);
+    d[3] = (uint8_t)oa;
+}
+
+// BT.601 limited range，和 YuvColor::from_rgb 一致
+static inline int rgb_to_y(int r, int g, int b) { return ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16; }
+static inline int rgb_to_u(int r, int g, int b) { return ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128; }
+static inline int rgb_to_v(int r, int g, int b) { return ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128; }
+
+// ---------------------------------------------------------------- OsdLayer
+
+void OsdLayer::begin_draw() {
+    dma_buf_sync_begin(dma_fd_, DMA_BUF_SYNC_RW);
+}
+
+void OsdLayer::end_draw() {
+    dma_buf_sync_end(dma_fd_, DMA_BUF_SYNC_RW);
+}
+
+bool OsdLayer::clip_and_track(int* x0, int* y0, int* x1, int* y1) {
+    *x0 = std::max(*x0, 0);
+    *y0 = std::max(*y0, 0);
+    *x1 = std::min(*x1, width_);
+    *y1 = std::min(*y1, height_);
+    if (*x0 >= *x1 || *y0 >= *y1) return false;
+    drawn_.push_back({*x0, *y0, *x1, *y1});
+    return true;
+}
+
+void OsdLayer::clear() {
+    for (const Rect& r : drawn_) {
+        for (int row = r.y0; row < r.y1; ++row) {
+            memset(pixels_ + ((size_t)row * width_ + r.x0) * 4, 0, (size_t)(r.x1 - r.x0) * 4);
+        }
+    }
+    drawn_.clear();
+}
+
+void OsdLayer::fill_rect(int x, int y, int w, int h, const OsdColor& color) {
+    int x0 = x, y0 = y, x1 = x + w, y1 = y + h;
+    if (!clip_and_track(&x0, &y0, &x1, &y1)) return;
+
+    const uint8_t px[4] = {color.r, color.g, color.b, color.a};
+    for (int row = y0; row < y1; ++row) {
+        uint8_t* d = pixels_ + ((size_t)row * width_ + x0) * 4;
+        for (int col = x0; col < x1; ++col, d += 4) memcpy(d, px, 4);
+    }
+}
+
+void OsdLayer::draw_rect(int x, int y, int w, int h, const OsdColor& color, int thickness) {
+    int t = std::max(thickness, 1);
+    if (w <= 2 * t || h <= 2 * t) {
+        fill_rect(x, y, w, h, color);
+        return;
+    }
+    // 四条边互不重叠
+    fill_rect(x, y, w, t, color);
+    fill_rect(x, y + h - t, w, t, color);
+    fill_rect(x, y + t, t, h - 2 * t, color);
+    fill_rect(x + w - t, y + t, t, h - 2 * t, color);
+}
+
+void OsdLayer::draw_text(const GlyphAtlas& atlas, int x, int baseline, const std::string& text,
+                         const OsdColor& color) {
+    if (text.empty()) return;
+    const Glyph& first = atlas.get(text[0]);
+    int x0 = x - first.left, y0 = baseline - first.baseline;
+    int x1 = x + atlas.text_width(text), y1 = y0 + first.height;
+    if (!clip_and_track(&x0, &y0, &x1, &y1)) return;
+
+    int pen = x;
+    for (char c : text) {
+        const Glyph& g = atlas.get(c);
+        int gx = pen - g.left;
+        int gy = baseline - g.baseline;
+        int cx0 = std::max(gx, x0), cy0 = std::max(gy, y0);
+        int cx1 = std::min(gx + g.width, x1), cy1 = std::min(gy + g.height, y1);
+        for (int row = cy0; row < cy1; ++row) {
+            const uint8_t* m = g.mask + (size_t)(row - gy) * g.stride;
+            uint8_t* d = pixels_ + ((size_t)row * width_ + cx0) * 4;
+            for (int col = cx0; col < cx1; ++col, d += 4) {
+                int a = m[col - gx];
+                if (a) blend_rgba(d, color, a * color.a / 255);
+            }
+        }
+        pen += g.advance;
+        if (pen >= width_) break;
+    }
+}
+
+// 一帧里单个图层最多拆成多少块混合 (检测框每个 4 条边 + 标签，几十个框以内都不会退化)
+static const size_t MAX_BLEND_REGIONS = 256;
+
+void OsdLayer::blend_regions(std::vector<Rect>* regions) const {
+    regions->clear();
+    Rect bounds = {width_, height_, 0, 0};
+    for (const Rect& drawn : drawn_) {
+        // 向外扩到偶数 (图层宽高本身是偶数，不会越界)
+        Rect r = {drawn.x0 & ~1, drawn.y0 & ~1,
+                  std::min((drawn.x1 + 1) & ~1, width_), std::min((drawn.y1 + 1) & ~1, height_)};
+        bounds = {std::min(bounds.x0, r.x0), std::min(bounds.y0, r.y0),
+                  std::max(bounds.x1, r.x1), std::max(bounds.y1, r.y1)};
+
+        // 减掉已经收下的区域：剩下的部分最多拆成上/下/左/右 4 块，坐标仍然是偶数
+        size_t first = regions->size();
+        regions->push_back(r);
+        for (size_t i = 0; i < first && regions->size() > first; ++i) {
+            const Rect a = (*regions)[i];
+            for (size_t j = first; j < regions->size();) {
+                Rect p = (*regions)[j];
+                if (p.x0 >= a.x1 || a.x0 >= p.x1 || p.y0 >= a.y1 || a.y0 >= p.y1) { ++j; continue; }
+                (*regions)[j] = regions->back();
+                regions->pop_back();
+                if (p.y0 < a.y0) regions->push_back({p.x0, p.y0, p.x1, a.y0});
+                if (a.y1 < p.y1) regions->push_back({p.x0, a.y1, p.x1, p.y1});
+                int my0 = std::max(p.y0, a.y0), my1 = std::min(p.y1, a.y1);
+                if (p.x0 < a.x0) regions->push_back({p.x0, my0, a.x0, my1});
+                if (a.x1 < p.x1) regions->push_back({a.x1, my0, p.x1, my1});
+                // 新加的块排在后面，和 a 不重叠，不用回头再检查
+            }
+        }
+        if (regions->size() > MAX_BLEND_REGIONS) break;
+    }
+    if (regions->size() > MAX_BLEND_REGIONS) {
+        regions->clear();
+        if (bounds.x0 < bounds.x1 && bounds.y0 < bounds.y1) regions->push_back(bounds);
+    }
+}
+
+// ---------------------------------------------------------------- OsdCompositor
+
+OsdCompositor::OsdCompositor() {}
+
+OsdCompositor::~OsdCompositor() {
+    for (OsdLayer* layer : layers_) {
+        if (layer->buffer_) {
+            rga_release_fd(layer->dma_fd_);
+            mpp_buffer_put(layer->buffer_);
+        }
+        delete layer;
+    }
+    layers_.clear();
+    if (group_) {
+        mpp_buffer_group_put(group_);
+        group_ = nullptr;
+    }
+}
+
+int OsdCompositor::init(bool use_rga) {
+    use_rga_ = use_rga;
+    // 图层主要是 CPU 写、RGA 读，用带缓存的内存，写完 dma_buf_sync_end 刷出去
+    MPP_RET ret = mpp_buffer_group_get_internal(&group_, (MppBufferType)(MPP_BUFFER_TYPE_DRM | MPP_BUFFER_FLAGS_CACHABLE));
+    if (ret != MPP_OK) {
+        cerr << ">>[OSD] 图层内存组分配失败" << endl;
+        return -1;
+    }
+    printf(">>[OSD] 图层合成: %s\n", use_rga_ ? "RGA" : "CPU");
+    return 0;
+}
+
+OsdLayer* OsdCompositor::add_layer(int x, int y, int width, int height) {
+    if (!group_) return nullptr;
+    OsdLayer* layer = new OsdLayer();
+    layer->x_ = x & ~1;
+    layer->y_ = y & ~1;
+    layer->width_ = (width + 1) & ~1;
+    layer->height_ = (height + 1) & ~1;
+
+    size_t size = (size_t)layer->width_ * layer->height_ * 4;
+    if (mpp_buffer_get(group_, &layer->buffer_, size) != MPP_OK) {
+        cerr << ">>[OSD] 图层内存分配失败: " << width << "x" << height << endl;
+        delete layer;
+        return nullptr;
+    }
+    layer->dma_fd_ = mpp_buffer_get_fd(layer->buffer_);
+    layer->pixels_ = (uint8_t*)mpp_buffer_get_ptr(layer->buffer_);
+
+    // 初始全透明
+    layer->begin_draw();
+    memset(layer->pixels_, 0, size);
+    layer->end_draw();
+
+    layers_.push_back(layer);
+    return layer;
+}
+
+int OsdCompositor::compose(int dst_fd, const Nv12Image& dst) {
+    // RGA 出过一次错就不再试了，后面都走 CPU
+    if (use_rga_ && !rga_failed_ && dst_fd >= 0) {
+        if (compose_rga(dst_fd, dst) == 0) return 0;
+        rga_failed_ = true;
+        cerr << ">>[OSD] RGA 图层混合失败，改用 CPU 混合" << endl;
+    }
+    if (!dst.data) return -1;
+
+    DmaBufCpuAccess cpu_access(dst_fd);
+    for (OsdLayer* layer : layers_) {
+        if (!layer->active()) continue;
+        layer->blend_regions(&regions_);
+        for (const OsdLayer::Rect& r : regions_) blend_cpu_region(*layer, r, dst);
+    }
+    return 0;
+}
+
+int OsdCompositor::compose_rga(int dst_fd, const Nv12Image& dst) {
+    // 所有图层放进同一个 job，一次提交，一次等待
+    // 图层和编码器输入都是常驻内存，RgaJob 里用的是缓存的 RGA 句柄
+    RgaImage dst_img = {dst.data, dst_fd, dst.width, dst.height, dst.stride, dst.ver_stride,
+                        RK_FORMAT_YCbCr_420_SP};
+    RgaJob job;
+    for (OsdLayer* layer : layers_) {
+        if (!layer->active()) continue;
+        RgaImage src_img = {layer->pixels_, layer->dma_fd_, layer->width_, layer->height_,
+                            layer->width_, layer->height_, RK_FORMAT_RGBA_8888};
+
+        // 每块画过的区域一个任务，只混合画过内容的地方 (全屏的检测框图层不会整帧混合)；
+        // 超出帧的部分裁掉
+        layer->blend_regions(&regions_);
+        for (const OsdLayer::Rect& r : regions_) {
+            int dx = layer->x_ + r.x0, dy = layer->y_ + r.y0;
+            int bw = std::min(r.x1 - r.x0, dst.width - dx) & ~1;
+            int bh = std::min(r.y1 - r.y0, dst.height - dy) & ~1;
+            if (bw <= 0 || bh <= 0) continue;
+
+            im_rect srect = {r.x0, r.y0, bw, bh};
+            im_rect drect = {dx, dy, bw, bh};
+            job.add_process(src_img, dst_img, srect, drect, IM_ALPHA_BLEND_SRC_OVER);
+        }
+    }
+    if (job.task_count() == 0) return 0;   // 没有要画的图层
+    return job.run();
+}
+
+void OsdCompositor::blend_cpu(const OsdLayer& layer, const Nv12Image& dst) {
+    std::vector<OsdLayer::Rect> regions;
+    layer.blend_regions(&regions);
+    for (const OsdLayer::Rect& r : regions) blend_cpu_region(layer, r, dst);
+}
+
+void OsdCompositor::blend_cpu_region(const OsdLayer& layer, const OsdLayer::Rect& r, const Nv12Image& dst) {
+    // 帧坐标下的范围 (偶数对齐)
+    int fx0 = std::max(layer.x() + r.x0, 0), fy0 = std::max(layer.y() + r.y0, 0);
+    int fx1 = std::min(layer.x() + r.x1, dst.width & ~1);
+    int fy1 = std::min(layer.y() + r.y1, dst.height & ~1);
+    const int stride = layer.width() * 4;
+
+    // 按 2x2 块处理：4 个 Y 各自混合，UV 用 4 个像素按 alpha 加权的平均
+    for (int fy = fy0; fy < fy1; fy += 2) {
+        uint8_t* uv = dst.uv_row(fy);
+        for (int fx = fx0; fx < fx1; fx += 2) {
+            int sum_a = 0, sum_u = 0, sum_v = 0;
+            for (int dy = 0; dy < 2; ++dy) {
+                const uint8_t* s = layer.pixels() + (size_t)(fy + dy - layer.y()) * stride
+                                 + (size_t)(fx - layer.x()) * 4;
+                uint8_t* py = dst.y_row(fy + dy) + fx;
+                for (int dx = 0; dx < 2; ++dx, s += 4) {
+                    int a = s[3];
+                    if (a == 0) continue;
+                    int y = rgb_to_y(s[0], s[1], s[2]);
+                    py[dx] = (uint8_t)((a * y + (255 - a) * py[dx] + 127) / 255);
+                    sum_a += a;
+                    sum_u += a * rgb_to_u(s[0], s[1], s[2]);
+                    sum_v += a * rgb_to_v(s[0], s[1], s[2]);
+                }
+            }
+            if (sum_a == 0) continue;
+            int a = sum_a / 4;
+            uv[fx]     = (uint8_t)((a * (sum_u / sum_a) + (255 - a) * uv[fx] + 127) / 255);
+            uv[fx + 1] = (uint8_t)((a * (sum_v / sum_a) + (255 - a) * uv[fx + 1] + 127) / 255);
+        }
+    }
+}
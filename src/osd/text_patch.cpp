@@ -0,0 +1,51 @@
+#include "osd/text_patch.h"
+#include <algorithm>
+#include <cstring>
+
+TextPatch::TextPatch(const GlyphAtlas& atlas, int width, int height, uint8_t bg_y, uint8_t fg_y)
+    : atlas_(atlas), width_(width), height_(height), bg_y_(bg_y), fg_y_(fg_y),
+      luma_((size_t)width * height, bg_y) {}
+
+bool TextPatch::update(const std::vector<TextSpan>& spans, int baseline) {
+    if (spans == spans_ && baseline == baseline_) return false;
+    spans_ = spans;
+    baseline_ = baseline;
+
+    // 1. 铺底色
+    std::fill(luma_.begin(), luma_.end(), bg_y_);
+
+    // 2. 逐字按覆盖程度混合前景色
+    for (const TextSpan& span : spans_) {
+        int pen = span.x;
+        for (char c : span.text) {
+            const Glyph& g = atlas_.get(c);
+            int gx0 = pen - g.left;
+            int gy0 = baseline_ - g.baseline;
+            int x0 = std::max(gx0, 0), y0 = std::max(gy0, 0);
+            int x1 = std::min(gx0 + g.width, width_), y1 = std::min(gy0 + g.height, height_);
+            for (int row = y0; row < y1; ++row) {
+                const uint8_t* m = g.mask + (size_t)(row - gy0) * g.stride;
+                uint8_t* dst = &luma_[(size_t)row * width_];
+                for (int col = x0; col < x1; ++col) {
+                    int a = m[col - gx0];
+                    if (a == 0) continue;
+                    dst[col] = (uint8_t)((a * fg_y_ + (255 - a) * dst[col] + 127) / 255);
+                }
+            }
+            pen += g.advance;
+            if (pen >= width_) break;
+        }
+    }
+    return true;
+}
+
+void TextPatch::blit(const Nv12Image& img, int x, int y) const {
+    int x0 = std::max(x, 0), y0 = std::max(y, 0);
+    int x1 = std::min(x + width_, img.width), y1 = std::min(y + height_, img.height);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    // 底色不透明，整行直接拷
+    for (int row = y0; row < y1; ++row) {
+        memcpy(img.y_row(row) + x0, &luma_[(size_t)(row - y) * width_ + (x0 - x)], x1 - x0);
+    }
+}
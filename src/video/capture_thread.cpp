@@ -0,0 +1,174 @@
+#include "video/capture_thread.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+using namespace std;
+
+CaptureThread::CaptureThread() {}
+
+CaptureThread::~CaptureThread() {
+    stop();
+}
+
+int CaptureThread::start(V4L2Device* camera) {
+    camera_ = camera;
+    int fd = camera_->get_fd();
+
+    // 1. 创建 epoll 和退出用的 eventfd
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || event_fd_ < 0) {
+        perror(">>[Capture] epoll/eventfd 创建失败");
+        stop();
+        return -1;
+    }
+
+    // 2. 监听摄像头可读 + 退出事件
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        perror(">>[Capture] epoll 添加摄像头失败");
+        stop();
+        return -1;
+    }
+    ev.data.fd = event_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &ev) < 0) {
+        perror(">>[Capture] epoll 添加 eventfd 失败");
+        stop();
+        return -1;
+    }
+
+    // 3. 启动线程
+    stopped_ = false;
+    quit_ = false;
+    thread_ = new std::thread(&CaptureThread::loop, this);
+    cout << ">>[Capture] 采集线程已启动" << endl;
+    return 0;
+}
+
+void CaptureThread::stop() {
+    if (thread_) {
+        // 唤醒 epoll_wait (或者正在等下游归还的采集线程)
+        {
+            // 持锁设置，免得采集线程刚检查完条件还没睡下就错过通知
+            std::lock_guard<std::mutex> lock(mtx_);
+            quit_ = true;
+        }
+        release_cv_.notify_all();
+        uint64_t one = 1;
+        if (write(event_fd_, &one, sizeof(one)) < 0) {
+            perror(">>[Capture] 写 eventfd 失败");
+        }
+        if (thread_->joinable()) thread_->join();
+        delete thread_;
+        thread_ = nullptr;
+        cout << ">>[Capture] 采集线程退出" << endl;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stopped_ = true;
+        // 还没被取走的帧还给驱动
+        for (const FrameInfo& info : pending_) {
+            camera_->return_frame(info.index);
+        }
+        pending_.clear();
+    }
+    cv_.notify_all();
+
+    if (epoll_fd_ >= 0) { close(epoll_fd_); epoll_fd_ = -1; }
+    if (event_fd_ >= 0) { close(event_fd_); event_fd_ = -1; }
+}
+
+bool CaptureThread::acquire(FrameInfo* info, int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    if (!cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                      [this]{ return !pending_.empty() || stopped_; })) {
+        return false;
+    }
+    if (pending_.empty()) return false;
+
+    // 所有权转给处理线程
+    *info = pending_.front();
+    pending_.pop_front();
+    return true;
+}
+
+void CaptureThread::release(int index) {
+    camera_->return_frame(index);
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        released_++;
+    }
+    release_cv_.notify_one();
+}
+
+void CaptureThread::wait_for_release(uint64_t seen, int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    release_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                         [&]{ return released_ != seen || quit_; });
+}
+
+void CaptureThread::loop() {
+    struct epoll_event events[2];
+
+    while (true) {
+        int n = epoll_wait(epoll_fd_, events, 2, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror(">>[Capture] epoll_wait 错误");
+            break;
+        }
+
+        bool quit = false;
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.fd == event_fd_) {
+                quit = true;
+                continue;
+            }
+
+            uint64_t released_before;
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                released_before = released_;
+            }
+
+            // 把驱动里已经就绪的帧全部取出来，只留最新的 max_pending_ 帧
+            FrameInfo info;
+            int index;
+            while ((index = camera_->dequeue_frame(&info)) >= 0) {
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    if (pending_.size() >= max_pending_) {
+                        // 最老的一帧没人要了，直接还给驱动
+                        camera_->return_frame(pending_.front().index);
+                        pending_.pop_front();
+                        skipped_++;
+                    }
+                    pending_.push_back(info);
+                }
+                cv_.notify_one();
+            }
+            if (index == -2) {
+                int err = errno;
+                // 一直出错的话每次唤醒都会走到这里，日志限频
+                if (++dqbuf_errors_ % 30 == 1) {
+                    cerr << ">>[Capture] DQBUF (取帧) 失败: " << strerror(err)
+                         << " (累计 " << dqbuf_errors_ << " 次)" << endl;
+                }
+            }
+            // 驱动里一个 buffer 都没有时 (全在下游手里，直通模式很容易这样) poll 会一直报 EPOLLERR，
+            // DQBUF 一直出错时 epoll 也会立刻再唤醒：都不空转，等下游归还一帧再取 (最多等 100ms)
+            if ((events[i].events & EPOLLERR) || index == -2) {
+                wait_for_release(released_before, 100);
+            }
+        }
+        if (quit) break;
+    }
+}
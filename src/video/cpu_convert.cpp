@@ -0,0 +1,510 @@
+#include "video/cpu_convert.h"
+#include <algorithm>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CPU_CONVERT_NEON 1
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#if defined(__SSE2__)
+#define CPU_CONVERT_SSE2 1
+#endif
+#define CPU_CONVERT_AVX2 1
+#endif
+
+// 所有实现按行工作，SIMD 版本处理整块，剩下的尾巴交给标量版本。
+// 定点公式在这里定死，SIMD 版本必须和它逐字节一致：
+//   Y = ((66R + 129G + 25B + 128) >> 8) + 16
+//   U = ((-38R - 74G + 112B + 128) >> 8) + 128
+//   V = ((112R - 94G - 18B + 128) >> 8) + 128
+//   c = (Y - 16) * 298, d = U - 128, e = V - 128
+//   R = clamp((c + 409e + 128) >> 8)
+//   G = clamp((c - 100d - 208e + 128) >> 8)
+//   B = clamp((c + 516d + 128) >> 8)
+//   (8 位系数，Y=235 正好到 255；c 超出 int16，SIMD 版本按 32 位算)
+//   双线性插值的权重是 7 位：(a * (128 - w) + b * w + 64) >> 7
+
+namespace {
+
+struct Kernels {
+    // 两行 YUYV -> 两行 Y + 一行 UV
+    void (*yuyv_rows)(const uint8_t* s0, const uint8_t* s1, uint8_t* y0, uint8_t* y1, uint8_t* uv, int width);
+    // 两行按权重 w (0~128) 插值
+    void (*lerp_row)(const uint8_t* a, const uint8_t* b, uint8_t* dst, int n, int w);
+    // 一行 Y + 一行 UV (每两个像素一对) -> 一行 RGB
+    void (*yuv_to_rgb_row)(const uint8_t* y, const uint8_t* uv, uint8_t* rgb, int width);
+    // 两行 RGB -> 两行 Y + 一行 UV
+    void (*rgb_rows)(const uint8_t* r0, const uint8_t* r1, uint8_t* y0, uint8_t* y1, uint8_t* uv, int width);
+};
+
+inline uint8_t clamp_u8(int v) {
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// ---------------------------------------------------------------- 标量参考实现
+
+void yuyv_rows_scalar(const uint8_t* s0, const uint8_t* s1, uint8_t* y0, uint8_t* y1, uint8_t* uv, int width) {
+    for (int x = 0; x < width; x += 2) {
+        const uint8_t* a = s0 + x * 2;
+        const uint8_t* b = s1 + x * 2;
+        y0[x] = a[0]; y0[x + 1] = a[2];
+        y1[x] = b[0]; y1[x + 1] = b[2];
+        uv[x] = (uint8_t)((a[1] + b[1] + 1) >> 1);
+        uv[x + 1] = (uint8_t)((a[3] + b[3] + 1) >> 1);
+    }
+}
+
+void lerp_row_scalar(const uint8_t* a, const uint8_t* b, uint8_t* dst, int n, int w) {
+    int iw = 128 - w;
+    for (int i = 0; i < n; ++i) dst[i] = (uint8_t)((a[i] * iw + b[i] * w + 64) >> 7);
+}
+
+void yuv_to_rgb_row_scalar(const uint8_t* y, const uint8_t* uv, uint8_t* rgb, int width) {
+    for (int x = 0; x < width; ++x) {
+        int c = (y[x] - 16) * 298;
+        int d = uv[x & ~1] - 128;
+        int e = uv[(x & ~1) + 1] - 128;
+        rgb[x * 3 + 0] = clamp_u8((c + 409 * e + 128) >> 8);
+        rgb[x * 3 + 1] = clamp_u8((c - 100 * d - 208 * e + 128) >> 8);
+        rgb[x * 3 + 2] = clamp_u8((c + 516 * d + 128) >> 8);
+    }
+}
+
+inline uint8_t rgb_y(int r, int g, int b) {
+    return (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+void rgb_rows_scalar(const uint8_t* r0, const uint8_t* r1, uint8_t* y0, uint8_t* y1, uint8_t* uv, int width) {
+    for (int x = 0; x < width; x += 2) {
+        const uint8_t* a = r0 + x * 3;
+        const uint8_t* b = r1 + x * 3;
+        y0[x] = rgb_y(a[0], a[1], a[2]);
+        y0[x + 1] = rgb_y(a[3], a[4], a[5]);
+        y1[x] = rgb_y(b[0], b[1], b[2]);
+        y1[x + 1] = rgb_y(b[3], b[4], b[5]);
+        int r = (a[0] + a[3] + b[0] + b[3] + 2) >> 2;
+        int g = (a[1] + a[4] + b[1] + b[4] + 2) >> 2;
+        int bl = (a[2] + a[5] + b[2] + b[5] + 2) >> 2;
+        uv[x] = (uint8_t)(((-38 * r - 74 * g + 112 * bl + 128) >> 8) + 128);
+        uv[x + 1] = (uint8_t)(((112 * r - 94 * g - 18 * bl + 128) >> 8) + 128);
+    }
+}
+
+const Kernels SCALAR_KERNELS = {yuyv_rows_scalar, lerp_row_scalar, yuv_to_rgb_row_scalar, rgb_rows_scalar};
+
+// ---------------------------------------------------------------- NEON
+
+#ifdef CPU_CONVERT_NEON
+
+void yuyv_rows_neon(const uint8_t* s0, const uint8_t* s1, uint8_t* y0, uint8_t* y1, uint8_t* uv, int width) {
+    int x = 0;
+    // 一次 16 个像素：vld2 正好把 YUYV 拆成 Y 和交错的 UV (UV 的排列就是 NV12 的)
+    for (; x + 16 <= width; x += 16) {
+        uint8x16x2_t a = vld2q_u8(s0 + x * 2);
+        uint8x16x2_t b = vld2q_u8(s1 + x * 2);
+        vst1q_u8(y0 + x, a.val[0]);
+        vst1q_u8(y1 + x, b.val[0]);
+        vst1q_u8(uv + x, vrhaddq_u8(a.val[1], b.val[1]));
+    }
+    if (x < width) yuyv_rows_scalar(s0 + x * 2, s1 + x * 2, y0 + x, y1 + x, uv + x, width - x);
+}
+
+void lerp_row_neon(const uint8_t* a, const uint8_t* b, uint8_t* dst, int n, int w) {
+    uint8x8_t wa = vdup_n_u8((uint8_t)(128 - w));
+    uint8x8_t wb = vdup_n_u8((uint8_t)w);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t va = vld1q_u8(a + i);
+        uint8x16_t vb = vld1q_u8(b + i);
+        uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(va), wa), vget_low_u8(vb), wb);
+        uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(va), wa), vget_high_u8(vb), wb);
+        vst1q_u8(dst + i, vcombine_u8(vrshrn_n_u16(lo, 7), vrshrn_n_u16(hi, 7)));
+    }
+    if (i < n) lerp_row_scalar(a + i, b + i, dst + i, n - i, w);
+}
+
+// 4 个像素的一个颜色分量：(298c + kd*d + ke*e + 128) >> 8，s32 累加，饱和收窄到 s16
+inline int16x4_t yuv_channel4_neon(int16x4_t c, int16x4_t d, int16x4_t e, int16_t kd, int16_t ke) {
+    int32x4_t acc = vmull_n_s16(c, 298);
+    acc = vmlal_n_s16(acc, d, kd);
+    acc = vmlal_n_s16(acc, e, ke);
+    return vqrshrn_n_s32(acc, 8);   // 带舍入的右移 = (x + 128) >> 8
+}
+
+inline uint8x8_t yuv_channel8_neon(int16x8_t c, int16x8_t d, int16x8_t e, int16_t kd, int16_t ke) {
+    int16x8_t v = vcombine_s16(yuv_channel4_neon(vget_low_s16(c), vget_low_s16(d), vget_low_s16(e), kd, ke),
+                               yuv_channel4_neon(vget_high_s16(c), vget_high_s16(d), vget_high_s16(e), kd, ke));
+    return vqmovun_s16(v);
+}
+
+// 8 个像素的 YUV -> RGB
+inline void yuv_to_rgb8_neon(uint8x8_t y, uint8x8_t u, uint8x8_t v, uint8x8_t* r, uint8x8_t* g, uint8x8_t* b) {
+    int16x8_t c = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(y)), vdupq_n_s16(16));
+    int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u)), vdupq_n_s16(128));
+    int16x8_t e = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v)), vdupq_n_s16(128));
+    *r = yuv_channel8_neon(c, d, e, 0, 409);
+    *g = yuv_channel8_neon(c, d, e, -100, -208);
+    *b = yuv_channel8_neon(c, d, e, 516, 0);
+}
+
+void yuv_to_rgb_row_neon(const uint8_t* y, const uint8_t* uv, uint8_t* rgb, int width) {
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x16_t vy = vld1q_u8(y + x);
+        uint8x8x2_t vuv = vld2_u8(uv + x);             // 8 对 UV
+        uint8x8x2_t u = vzip_u8(vuv.val[0], vuv.val[0]); // 每个 U 复制给两个像素
+        uint8x8x2_t v = vzip_u8(vuv.val[1], vuv.val[1]);
+        uint8x16x3_t out;
+        uint8x8_t r0, g0, b0, r1, g1, b1;
+        yuv_to_rgb8_neon(vget_low_u8(vy), u.val[0], v.val[0], &r0, &g0, &b0);
+        yuv_to_rgb8_neon(vget_high_u8(vy), u.val[1], v.val[1], &r1, &g1, &b1);
+        out.val[0] = vcombine_u8(r0, r1);
+        out.val[1] = vcombine_u8(g0, g1);
+        out.val[2] = vcombine_u8(b0, b1);
+        vst3q_u8(rgb + x * 3, out);
+    }
+    if (x < width) yuv_to_rgb_row_scalar(y + x, uv + x, rgb + x * 3, width - x);
+}
+
+inline uint8x8_t rgb_y8_neon(uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+    uint16x8_t s = vmull_u8(r, vdup_n_u8(66));
+    s = vmlal_u8(s, g, vdup_n_u8(129));
+    s = vmlal_u8(s, b, vdup_n_u8(25));
+    return vadd_u8(vshrn_n_u16(vaddq_u16(s, vdupq_n_u16(128)), 8), vdup_n_u8(16));
+}
+
+inline uint8x16_t rgb_y16_neon(const uint8x16x3_t& p) {
+    return vcombine_u8(rgb_y8_neon(vget_low_u8(p.val[0]), vget_low_u8(p.val[1]), vget_low_u8(p.val[2])),
+                       rgb_y8_neon(vget_high_u8(p.val[0]), vget_high_u8(p.val[1]), vget_high_u8(p.val[2])));
+}
+
+// 2x2 平均：横向两两相加 (vpaddl)，再加上下两行
+inline int16x8_t avg2x2_neon(uint8x16_t a, uint8x16_t b) {
+    uint16x8_t s = vaddq_u16(vpaddlq_u8(a), vpaddlq_u8(b));
+    return vreinterpretq_s16_u16(vshrq_n_u16(vaddq_u16(s, vdupq_n_u16(2)), 2));
+}
+
+void rgb_rows_neon(const uint8_t* r0, const uint8_t* r1, uint8_t* y0, uint8_t* y1, uint8_t* uv, int width) {
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x16x3_t a = vld3q_u8(r0 + x * 3);
+        uint8x16x3_t b = vld3q_u8(r1 + x * 3);
+        vst1q_u8(y0 + x, rgb_y16_neon(a));
+        vst1q_u8(y1 + x, rgb_y16_neon(b));
+
+        int16x8_t r = avg2x2_neon(a.val[0], b.val[0]);
+        int16x8_t g = avg2x2_neon(a.val[1], b.val[1]);
+        int16x8_t bl = avg2x2_neon(a.val[2], b.val[2]);
+        int16x8_t u = vmulq_n_s16(r, -38);
+        u = vmlaq_n_s16(u, g, -74);
+        u = vmlaq_n_s16(u, bl, 112);
+        int16x8_t v = vmulq_n_s16(r, 112);
+        v = vmlaq_n_s16(v, g, -94);
+        v = vmlaq_n_s16(v, bl, -18);
+        int16x8_t bias = vdupq_n_s16(128);
+        uint8x8x2_t out;
+        out.val[0] = vqmovun_s16(vaddq_s16(vshrq_n_s16(vaddq_s16(u, bias), 8), bias));
+        out.val[1] = vqmovun_s16(vaddq_s16(vshrq_n_s16(vaddq_s16(v, bias), 8), bias));
+        vst2_u8(uv + x, out);
+    }
+    if (x < width) rgb_rows_scalar(r0 + x * 3, r1 + x * 3, y0 + x, y1 + x, uv + x, width - x);
+}
+
+const Kernels NEON_KERNELS = {yuyv_rows_neon, lerp_row_neon, yuv_to_rgb_row_neon, rgb_rows_neon};
+
+#endif // CPU_CONVERT_NEON
+
+// ---------------------------------------------------------------- SSE2
+
+#ifdef CPU_CONVERT_SSE2
+
+void yuyv_rows_sse2(const uint8_t* s0, const uint8_t* s1, uint8_t* y0, uint8_t* y1, uint8_t* uv, int width) {
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    int x = 0;
+    // 一次 16 个像素 (每行 32 字节)：低字节是 Y，高字节是 U/V
+    for (; x + 16 <= width; x += 16) {
+        __m128i a0 = _mm_loadu_si128((const __m128i*)(s0 + x * 2));
+        __m128i a1 = _mm_loadu_si128((const __m128i*)(s0 + x * 2 + 16));
+        __m128i b0 = _mm_loadu_si128((const __m128i*)(s1 + x * 2));
+        __m128i b1 = _mm_loadu_si128((const __m128i*)(s1 + x * 2 + 16));
+        _mm_storeu_si128((__m128i*)(y0 + x), _mm_packus_epi16(_mm_and_si128(a0, mask), _mm_and_si128(a1, mask)));
+        _mm_storeu_si128((__m128i*)(y1 + x), _mm_packus_epi16(_mm_and_si128(b0, mask), _mm_and_si128(b1, mask)));
+        __m128i ua = _mm_packus_epi16(_mm_srli_epi16(a0, 8), _mm_srli_epi16(a1, 8));
+        __m128i ub = _mm_packus_epi16(_mm_srli_epi16(b0, 8), _mm_srli_epi16(b1, 8));
+        _mm_storeu_si128((__m128i*)(uv + x), _mm_avg_epu8(ua, ub));
+    }
+    if (x < width) yuyv_rows_scalar(s0 + x * 2, s1 + x * 2, y0 + x, y1 + x, uv + x, width - x);
+}
+
+void lerp_row_sse2(const uint8_t* a, const uint8_t* b, uint8_t* dst, int n, int w) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wa = _mm_set1_epi16((short)(128 - w));
+    const __m128i wb = _mm_set1_epi16((short)w);
+    const __m128i round = _mm_set1_epi16(64);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), wa),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wb));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), wa),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wb));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 7);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 7);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    if (i < n) lerp_row_scalar(a + i, b + i, dst + i, n - i, w);
+}
+
+// 8 个像素的一个颜色分量：(298c + k1*x1 + k2*x2 + 128) >> 8
+// madd 把相邻两个 s16 乘加成 s32：[c, x1] * [298, k1] + [x2, 0] * [k2, 0]，最后饱和收窄到 u8
+inline __m128i yuv_channel8_sse2(__m128i c, __m128i x1, __m128i x2, short k1, short k2) {
+    const __m128i zero = _mm_setzero_si128(), round = _mm_set1_epi32(128);
+    const __m128i kc = _mm_set_epi16(k1, 298, k1, 298, k1, 298, k1, 298);
+    const __m128i k = _mm_set_epi16(0, k2, 0, k2, 0, k2, 0, k2);
+    __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(c, x1), kc),
+                               _mm_madd_epi16(_mm_unpacklo_epi16(x2, zero), k));
+    __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(c, x1), kc),
+                               _mm_madd_epi16(_mm_unpackhi_epi16(x2, zero), k));
+    lo = _mm_srai_epi32(_mm_add_epi32(lo, round), 8);
+    hi = _mm_srai_epi32(_mm_add_epi32(hi, round), 8);
+    return _mm_packus_epi16(_mm_packs_epi32(lo, hi), zero);
+}
+
+// SSE2 没有 3 通道交错存储，RGB 算成三个向量后逐像素写出
+void yuv_to_rgb_row_sse2(const uint8_t* y, const uint8_t* uv, uint8_t* rgb, int width) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i k16 = _mm_set1_epi16(16), k128 = _mm_set1_epi16(128);
+    alignas(16) uint8_t r[16], g[16], b[16];
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128i vy = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(y + x)), zero);
+        __m128i vuv = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(uv + x)), zero), k128);
+        // [u0 v0 u1 v1 ...] -> [u0 u0 u1 u1 ...] / [v0 v0 v1 v1 ...]
+        __m128i d = _mm_shufflehi_epi16(_mm_shufflelo_epi16(vuv, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0));
+        __m128i e = _mm_shufflehi_epi16(_mm_shufflelo_epi16(vuv, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+        __m128i c = _mm_sub_epi16(vy, k16);
+        _mm_storel_epi64((__m128i*)r, yuv_channel8_sse2(c, e, zero, 409, 0));
+        _mm_storel_epi64((__m128i*)g, yuv_channel8_sse2(c, d, e, -100, -208));
+        _mm_storel_epi64((__m128i*)b, yuv_channel8_sse2(c, d, zero, 516, 0));
+        uint8_t* out = rgb + x * 3;
+        for (int i = 0; i < 8; ++i, out += 3) {
+            out[0] = r[i]; out[1] = g[i]; out[2] = b[i];
+        }
+    }
+    if (x < width) yuv_to_rgb_row_scalar(y + x, uv + x, rgb + x * 3, width - x);
+}
+
+// RGB 打包格式在 SSE2 上解交错不划算，RGB -> NV12 用标量
+const Kernels SSE2_KERNELS = {yuyv_rows_sse2, lerp_row_sse2, yuv_to_rgb_row_sse2, rgb_rows_scalar};
+
+#endif // CPU_CONVERT_SSE2
+
+// ---------------------------------------------------------------- AVX2
+
+#if defined(CPU_CONVERT_AVX2) && defined(CPU_CONVERT_SSE2)
+
+__attribute__((target("avx2")))
+void yuyv_rows_avx2(const uint8_t* s0, const uint8_t* s1, uint8_t* y0, uint8_t* y1, uint8_t* uv, int width) {
+    const __m256i mask = _mm256_set1_epi16(0x00FF);
+    int x = 0;
+    // packus 是按 128 位分开做的，结果要用 permute4x64 把中间两段换回来
+    for (; x + 32 <= width; x += 32) {
+        __m256i a0 = _mm256_loadu_si256((const __m256i*)(s0 + x * 2));
+        __m256i a1 = _mm256_loadu_si256((const __m256i*)(s0 + x * 2 + 32));
+        __m256i b0 = _mm256_loadu_si256((const __m256i*)(s1 + x * 2));
+        __m256i b1 = _mm256_loadu_si256((const __m256i*)(s1 + x * 2 + 32));
+        __m256i ya = _mm256_packus_epi16(_mm256_and_si256(a0, mask), _mm256_and_si256(a1, mask));
+        __m256i yb = _mm256_packus_epi16(_mm256_and_si256(b0, mask), _mm256_and_si256(b1, mask));
+        __m256i ua = _mm256_packus_epi16(_mm256_srli_epi16(a0, 8), _mm256_srli_epi16(a1, 8));
+        __m256i ub = _mm256_packus_epi16(_mm256_srli_epi16(b0, 8), _mm256_srli_epi16(b1, 8));
+        _mm256_storeu_si256((__m256i*)(y0 + x), _mm256_permute4x64_epi64(ya, 0xD8));
+        _mm256_storeu_si256((__m256i*)(y1 + x), _mm256_permute4x64_epi64(yb, 0xD8));
+        _mm256_storeu_si256((__m256i*)(uv + x), _mm256_permute4x64_epi64(_mm256_avg_epu8(ua, ub), 0xD8));
+    }
+    if (x < width) yuyv_rows_sse2(s0 + x * 2, s1 + x * 2, y0 + x, y1 + x, uv + x, width - x);
+}
+
+__attribute__((target("avx2")))
+void lerp_row_avx2(const uint8_t* a, const uint8_t* b, uint8_t* dst, int n, int w) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i wa = _mm256_set1_epi16((short)(128 - w));
+    const __m256i wb = _mm256_set1_epi16((short)w);
+    const __m256i round = _mm256_set1_epi16(64);
+    int i = 0;
+    // unpack 和 packus 都在各自的 128 位里做，顺序不会乱
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(va, zero), wa),
+                                      _mm256_mullo_epi16(_mm256_unpacklo_epi8(vb, zero), wb));
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(va, zero), wa),
+                                      _mm256_mullo_epi16(_mm256_unpackhi_epi8(vb, zero), wb));
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, round), 7);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, round), 7);
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    if (i < n) lerp_row_sse2(a + i, b + i, dst + i, n - i, w);
+}
+
+const Kernels AVX2_KERNELS = {yuyv_rows_avx2, lerp_row_avx2, yuv_to_rgb_row_sse2, rgb_rows_scalar};
+
+#endif // CPU_CONVERT_AVX2
+
+const Kernels& kernels_for(CpuIsa isa) {
+    if (isa == CPU_ISA_AUTO || !cpu_isa_supported(isa)) isa = cpu_isa_best();
+    switch (isa) {
+#ifdef CPU_CONVERT_NEON
+    case CPU_ISA_NEON: return NEON_KERNELS;
+#endif
+#ifdef CPU_CONVERT_SSE2
+    case CPU_ISA_SSE2: return SSE2_KERNELS;
+#endif
+#if defined(CPU_CONVERT_AVX2) && defined(CPU_CONVERT_SSE2)
+    case CPU_ISA_AVX2: return AVX2_KERNELS;
+#endif
+    default: return SCALAR_KERNELS;
+    }
+}
+
+// 双线性采样位置：目标第 i 个像素中心对应源坐标 (16.16 定点)，拆成整数下标 + 7 位权重
+void sample_positions(int src_n, int dst_n, std::vector<int>* index, std::vector<uint8_t>* weight) {
+    index->resize(dst_n);
+    weight->resize(dst_n);
+    for (int i = 0; i < dst_n; ++i) {
+        int64_t f = ((int64_t)(2 * i + 1) * src_n << 16) / (2 * dst_n) - 32768;
+        f = std::max<int64_t>(f, 0);
+        int idx = (int)(f >> 16);
+        int w = (int)((f & 0xFFFF) >> 9);
+        if (idx >= src_n - 1) { idx = src_n - 1; w = 0; }
+        (*index)[i] = idx;
+        (*weight)[i] = (uint8_t)w;
+    }
+}
+
+} // namespace
+
+void CpuScaleCache::prepare(int sw, int sh, int dw, int dh) {
+    if (sw == src_w && sh == src_h && dw == dst_w && dh == dst_h) return;
+    src_w = sw; src_h = sh; dst_w = dw; dst_h = dh;
+    sample_positions(sh, dh, &ys, &wys);
+    sample_positions(sw, dw, &xs, &wxs);
+    sample_positions(sh / 2, dh, &cys, &wcys);
+    sample_positions(sw / 2, dw / 2, &cxs, &wcxs);
+    vy.resize(sw);
+    vuv.resize(sw);
+    hy.resize(dw);
+    huv.resize(dw);
+}
+
+// ---------------------------------------------------------------- 选择
+
+const char* cpu_isa_name(CpuIsa isa) {
+    switch (isa) {
+    case CPU_ISA_AUTO:   return cpu_isa_name(cpu_isa_best());
+    case CPU_ISA_SCALAR: return "scalar";
+    case CPU_ISA_NEON:   return "neon";
+    case CPU_ISA_SSE2:   return "sse2";
+    case CPU_ISA_AVX2:   return "avx2";
+    }
+    return "unknown";
+}
+
+bool cpu_isa_supported(CpuIsa isa) {
+    switch (isa) {
+    case CPU_ISA_AUTO:
+    case CPU_ISA_SCALAR:
+        return true;
+#ifdef CPU_CONVERT_NEON
+    case CPU_ISA_NEON:
+        return true;
+#endif
+#ifdef CPU_CONVERT_SSE2
+    case CPU_ISA_SSE2:
+        return true;
+#endif
+#if defined(CPU_CONVERT_AVX2) && defined(CPU_CONVERT_SSE2)
+    case CPU_ISA_AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+CpuIsa cpu_isa_best() {
+    static const CpuIsa best = [] {
+        const CpuIsa order[] = {CPU_ISA_NEON, CPU_ISA_AVX2, CPU_ISA_SSE2};
+        for (CpuIsa isa : order) {
+            if (cpu_isa_supported(isa)) return isa;
+        }
+        return CPU_ISA_SCALAR;
+    }();
+    return best;
+}
+
+// ---------------------------------------------------------------- 转换
+
+void cpu_yuyv_to_nv12(const uint8_t* src, int src_stride, int width, int height,
+                      uint8_t* dst_y, int y_stride, uint8_t* dst_uv, int uv_stride, CpuIsa isa) {
+    const Kernels& k = kernels_for(isa);
+    for (int row = 0; row + 1 < height; row += 2) {
+        k.yuyv_rows(src + (size_t)row * src_stride, src + (size_t)(row + 1) * src_stride,
+                    dst_y + (size_t)row * y_stride, dst_y + (size_t)(row + 1) * y_stride,
+                    dst_uv + (size_t)(row / 2) * uv_stride, width);
+    }
+}
+
+void cpu_nv12_to_rgb(const uint8_t* src_y, int y_stride, const uint8_t* src_uv, int uv_stride,
+                     int src_w, int src_h,
+                     uint8_t* dst, int dst_stride, int dst_w, int dst_h, CpuIsa isa, CpuScaleCache* cache) {
+    const Kernels& k = kernels_for(isa);
+    const int src_cw = src_w / 2, src_ch = src_h / 2;
+    const int dst_cw = dst_w / 2;
+
+    // 采样位置和行缓冲只和尺寸有关，尺寸没变就直接用上次的
+    CpuScaleCache local;
+    CpuScaleCache& sc = cache ? *cache : local;
+    sc.prepare(src_w, src_h, dst_w, dst_h);
+    const std::vector<int> &ys = sc.ys, &xs = sc.xs, &cys = sc.cys, &cxs = sc.cxs;
+    const std::vector<uint8_t> &wys = sc.wys, &wxs = sc.wxs, &wcys = sc.wcys, &wcxs = sc.wcxs;
+    std::vector<uint8_t> &vy = sc.vy, &vuv = sc.vuv, &hy = sc.hy, &huv = sc.huv;
+
+    // 先竖直插值出整行 (SIMD)，再按位置横向插值 (标量)，最后整行转 RGB (SIMD)
+    for (int dy = 0; dy < dst_h; ++dy) {
+        int y0 = ys[dy], y1 = std::min(y0 + 1, src_h - 1);
+        k.lerp_row(src_y + (size_t)y0 * y_stride, src_y + (size_t)y1 * y_stride, vy.data(), src_w, wys[dy]);
+        int c0 = cys[dy], c1 = std::min(c0 + 1, src_ch - 1);
+        k.lerp_row(src_uv + (size_t)c0 * uv_stride, src_uv + (size_t)c1 * uv_stride, vuv.data(), src_w, wcys[dy]);
+
+        const uint8_t* ry = vy.data();
+        const uint8_t* ruv = vuv.data();
+        if (dst_w != src_w) {
+            for (int dx = 0; dx < dst_w; ++dx) {
+                int x0 = xs[dx], x1 = std::min(x0 + 1, src_w - 1), w = wxs[dx];
+                hy[dx] = (uint8_t)((vy[x0] * (128 - w) + vy[x1] * w + 64) >> 7);
+            }
+            for (int cx = 0; cx < dst_cw; ++cx) {
+                int x0 = cxs[cx], x1 = std::min(x0 + 1, src_cw - 1), w = wcxs[cx];
+                huv[cx * 2] = (uint8_t)((vuv[x0 * 2] * (128 - w) + vuv[x1 * 2] * w + 64) >> 7);
+                huv[cx * 2 + 1] = (uint8_t)((vuv[x0 * 2 + 1] * (128 - w) + vuv[x1 * 2 + 1] * w + 64) >> 7);
+            }
+            ry = hy.data();
+            ruv = huv.data();
+        }
+        k.yuv_to_rgb_row(ry, ruv, dst + (size_t)dy * dst_stride, dst_w);
+    }
+}
+
+void cpu_rgb_to_nv12(const uint8_t* src, int src_stride, int width, int height,
+                     uint8_t* dst_y, int y_stride, uint8_t* dst_uv, int uv_stride, CpuIsa isa) {
+    const Kernels& k = kernels_for(isa);
+    for (int row = 0; row + 1 < height; row += 2) {
+        k.rgb_rows(src + (size_t)row * src_stride, src + (size_t)(row + 1) * src_stride,
+                   dst_y + (size_t)row * y_stride, dst_y + (size_t)(row + 1) * y_stride,
+                   dst_uv + (size_t)(row / 2) * uv_stride, width);
+    }
+}
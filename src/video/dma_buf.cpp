@@ -0,0 +1,32 @@
+#include "video/dma_buf.h"
+#include <cerrno>
+#include <cstdio>
+#include <sys/ioctl.h>
+
+static int dma_buf_sync(int fd, unsigned long long flags) {
+    if (fd < 0) return -1;
+    struct dma_buf_sync sync;
+    sync.flags = flags;
+    // 被信号打断就重来，其他错误只报一次，免得每帧刷屏
+    int ret;
+    do {
+        ret = ioctl(fd, DMA_BUF_IOCTL_SYNC, &sync);
+    } while (ret < 0 && (errno == EINTR || errno == EAGAIN));
+    if (ret < 0) {
+        static bool warned = false;
+        if (!warned) {
+            perror(">>[DMA-BUF] DMA_BUF_IOCTL_SYNC 失败");
+            warned = true;
+        }
+        return -1;
+    }
+    return 0;
+}
+
+int dma_buf_sync_begin(int fd, unsigned int flags) {
+    return dma_buf_sync(fd, DMA_BUF_SYNC_START | flags);
+}
+
+int dma_buf_sync_end(int fd, unsigned int flags) {
+    return dma_buf_sync(fd, DMA_BUF_SYNC_END | flags);
+}
@@ -0,0 +1,153 @@
+#include "video/dma_heap.h"
+#include "video/rga.h"
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/dma-heap.h>
+#include <cstring>
+
+using namespace std;
+
+// RGA 在 RK3576 上只能寻址 4G 以下，优先 dma32 的 heap；带缓存的 heap CPU 读写快，
+// CPU 访问前后用 DMA_BUF_IOCTL_SYNC 同步
+static const char* HEAP_NAMES[] = {
+    "system-dma32",
+    "system",
+    "cma",
+};
+
+static const size_t PAGE = 4096;
+static const size_t CLASS_GRANULE = 64 * 1024;
+
+DmaHeapPool::DmaHeapPool() {}
+
+DmaHeapPool::~DmaHeapPool() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto& entry : free_) {
+        for (DmaHeapBuffer& buf : entry.second) free_buffer(&buf);
+    }
+    free_.clear();
+    if (outstanding_ > 0) {
+        cerr << ">>[DmaHeap] 还有 " << outstanding_ << " 块内存没有归还" << endl;
+    }
+    if (heap_fd_ >= 0) {
+        close(heap_fd_);
+        heap_fd_ = -1;
+    }
+}
+
+int DmaHeapPool::init() {
+    for (const char* name : HEAP_NAMES) {
+        string path = string("/dev/dma_heap/") + name;
+        int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+        if (fd >= 0) {
+            heap_fd_ = fd;
+            heap_name_ = name;
+            cout << ">>[DmaHeap] 使用 " << path << endl;
+            return 0;
+        }
+    }
+    heap_name_ = "memfd";
+    cout << ">>[DmaHeap] 没有可用的 dma_heap，退回 memfd (RGA 走虚拟地址，NPU 不能零拷贝)" << endl;
+    return 0;
+}
+
+// 小块按页对齐，大块按 64K 一档，同一类用途 (比如每路的 AI 输入) 落在同一档里
+size_t DmaHeapPool::size_class(size_t size) {
+    size_t granule = (size >= CLASS_GRANULE) ? CLASS_GRANULE : PAGE;
+    return (size + granule - 1) / granule * granule;
+}
+
+int DmaHeapPool::acquire(size_t size, DmaHeapBuffer* out) {
+    if (size == 0) return -1;
+    size_t cls = size_class(size);
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        auto it = free_.find(cls);
+        if (it != free_.end() && !it->second.empty()) {
+            *out = it->second.back();
+            it->second.pop_back();
+            ++outstanding_;
+            return 0;
+        }
+    }
+
+    int ret = (heap_fd_ >= 0) ? alloc_heap(cls, out) : alloc_memfd(cls, out);
+    if (ret < 0 && heap_fd_ >= 0) {
+        cerr << ">>[DmaHeap] " << heap_name_ << " 分配 " << cls << " 字节失败，退回 memfd" << endl;
+        ret = alloc_memfd(cls, out);
+    }
+    if (ret < 0) return -1;
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    ++outstanding_;
+    return 0;
+}
+
+void DmaHeapPool::release(DmaHeapBuffer* buf) {
+    if (!buf || !buf->ptr) return;
+    std::lock_guard<std::mutex> lock(mtx_);
+    free_[buf->size].push_back(*buf);
+    if (outstanding_ > 0) --outstanding_;
+    *buf = DmaHeapBuffer();
+}
+
+int DmaHeapPool::alloc_heap(size_t size, DmaHeapBuffer* out) {
+    struct dma_heap_allocation_data data;
+    memset(&data, 0, sizeof(data));
+    data.len = size;
+    data.fd_flags = O_RDWR | O_CLOEXEC;
+    if (ioctl(heap_fd_, DMA_HEAP_IOCTL_ALLOC, &data) < 0) {
+        perror(">>[DmaHeap] DMA_HEAP_IOCTL_ALLOC");
+        return -1;
+    }
+
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, (int)data.fd, 0);
+    if (ptr == MAP_FAILED) {
+        perror(">>[DmaHeap] mmap");
+        close((int)data.fd);
+        return -1;
+    }
+    out->fd = (int)data.fd;
+    out->ptr = ptr;
+    out->size = size;
+    out->backing_fd = -1;
+    return 0;
+}
+
+int DmaHeapPool::alloc_memfd(size_t size, DmaHeapBuffer* out) {
+    int fd = (int)syscall(SYS_memfd_create, "dma_heap_pool", 1u /* MFD_CLOEXEC */);
+    if (fd < 0) {
+        perror(">>[DmaHeap] memfd_create");
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)size) < 0) {
+        perror(">>[DmaHeap] ftruncate");
+        close(fd);
+        return -1;
+    }
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+        perror(">>[DmaHeap] mmap");
+        close(fd);
+        return -1;
+    }
+    out->fd = -1;
+    out->ptr = ptr;
+    out->size = size;
+    out->backing_fd = fd;
+    return 0;
+}
+
+void DmaHeapPool::free_buffer(DmaHeapBuffer* buf) {
+    // RGA 可能按 fd 或地址缓存了句柄
+    if (buf->fd >= 0) rga_release_fd(buf->fd);
+    rga_release_virt(buf->ptr);
+    if (buf->ptr) munmap(buf->ptr, buf->size);
+    if (buf->fd >= 0) close(buf->fd);
+    if (buf->backing_fd >= 0) close(buf->backing_fd);
+    *buf = DmaHeapBuffer();
+}
@@ -0,0 +1,101 @@
+#include "video/file_source.h"
+#include "video/rga.h"
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+FileFrameSource::FileFrameSource(const std::string& path, const std::string& pixel_format, bool paced)
+    : path_(path), pixel_format_(pixel_format), paced_(paced) {}
+
+FileFrameSource::~FileFrameSource() {
+    stop();
+    if (map_) {
+        rga_release_virt_range(map_, map_size_);   // 每帧一个偏移，都可能被 RGA 导入过
+        munmap(map_, map_size_);
+        map_ = nullptr;
+    }
+    if (fd_ >= 0) { close(fd_); fd_ = -1; }
+}
+
+int FileFrameSource::open(int width, int height, int fps) {
+    width_ = width;
+    height_ = height;
+    fps_ = fps;
+
+    // 1. 按像素格式算单帧大小
+    if (pixel_format_ == "yuyv") {
+        format_ = RK_FORMAT_YUYV_422;
+        frame_size_ = (size_t)width * height * 2;
+    } else if (pixel_format_ == "nv12") {
+        format_ = RK_FORMAT_YCbCr_420_SP;
+        frame_size_ = (size_t)width * height * 3 / 2;
+    } else {
+        cerr << ">>[File] 不支持的像素格式: " << pixel_format_ << " (只支持 nv12/yuyv)" << endl;
+        return -1;
+    }
+
+    // 2. 打开并整体映射 (只读)
+    fd_ = ::open(path_.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        perror(">>[File] 无法打开回放文件");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) < 0 || (size_t)st.st_size < frame_size_) {
+        cerr << ">>[File] 文件太小，不够一帧: " << path_ << endl;
+        return -1;
+    }
+    map_size_ = st.st_size;
+    map_ = mmap(NULL, map_size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+        perror(">>[File] mmap 失败");
+        return -1;
+    }
+    // 顺序读，让内核提前预读
+    madvise(map_, map_size_, MADV_SEQUENTIAL);
+
+    frame_count_ = (int)(map_size_ / frame_size_);
+    printf(">>[File] 回放文件: %s | %dx%d %s | %d 帧 | %s\n",
+           path_.c_str(), width, height, pixel_format_.c_str(), frame_count_,
+           paced_ ? "按帧率" : "全速");
+    return 0;
+}
+
+int FileFrameSource::start() {
+    if (!map_) return -1;
+    next_frame_ = 0;
+    pacer_.reset(fps_, paced_);
+    running_ = true;
+    return 0;
+}
+
+void FileFrameSource::stop() {
+    running_ = false;
+}
+
+bool FileFrameSource::acquire(SourceFrame* frame, int timeout_ms) {
+    if (!running_) return false;
+    if (!pacer_.wait(timeout_ms)) return false;
+
+    // 帧直接指向映射区，放完一遍从头循环
+    int index = next_frame_;
+    next_frame_ = (next_frame_ + 1) % frame_count_;
+
+    frame->index = index;
+    frame->dma_fd = -1;
+    frame->virt = (uint8_t*)map_ + (size_t)index * frame_size_;
+    frame->size = frame_size_;
+    frame->format = format_;
+    frame->hor_stride = width_;
+    frame->ver_stride = height_;
+    frame->info.index = index;
+    frame->info.timestamp_us = FramePacer::now_us();
+    frame->info.sequence = sequence_++;
+    frame->info.bytesused = frame_size_;
+    return true;
+}
@@ -0,0 +1,156 @@
+#include "video/frame_pyramid.h"
+#include "video/dma_buf.h"
+#include <iostream>
+#include <cstring>
+
+using namespace std;
+
+FramePyramid::FramePyramid() {
+    memset(levels_, 0, sizeof(levels_));
+    memset(&src_, 0, sizeof(src_));
+    memset(regions_, 0, sizeof(regions_));
+    for (int i = 0; i < PYRAMID_LEVEL_COUNT; ++i) {
+        enabled_[i] = false;
+        cpu_[i] = false;
+        on_rga_[i] = false;
+        has_region_[i] = false;
+        pad_colors_[i] = 0;
+        pad_pending_[i] = false;
+    }
+}
+
+void FramePyramid::set_level(PyramidLevel level, const RgaImage& img) {
+    levels_[level] = img;
+    enabled_[level] = true;
+    has_region_[level] = false;
+    pad_pending_[level] = false;
+}
+
+void FramePyramid::set_level(PyramidLevel level, const RgaImage& img, const im_rect& region, uint32_t pad_color) {
+    levels_[level] = img;
+    enabled_[level] = true;
+    has_region_[level] = true;
+    regions_[level] = region;
+    pad_colors_[level] = pad_color;
+    pad_pending_[level] = true;
+}
+
+// region 以外的部分 (上下左右最多四块)
+static int pad_rects(const RgaImage& img, const im_rect& r, im_rect out[4]) {
+    int n = 0;
+    int bottom = r.y + r.height, right = r.x + r.width;
+    if (r.y > 0)               out[n++] = {0, 0, img.width, r.y};
+    if (bottom < img.height)   out[n++] = {0, bottom, img.width, img.height - bottom};
+    if (r.x > 0)               out[n++] = {0, r.y, r.x, r.height};
+    if (right < img.width)     out[n++] = {right, r.y, img.width - right, r.height};
+    return n;
+}
+
+// region 对应的子图 (CPU 用，只对打包的 RGB888 有意义)
+static RgaImage sub_image(const RgaImage& img, const im_rect& r) {
+    RgaImage sub = img;
+    sub.ptr = (uint8_t*)img.ptr + ((size_t)r.y * img.wstride + r.x) * 3;
+    sub.width = r.width;
+    sub.height = r.height;
+    return sub;
+}
+
+// CPU 填充 RGB888 的一块
+static void fill_rgb(const RgaImage& img, const im_rect& r, uint32_t color) {
+    uint8_t px[3] = {(uint8_t)(color & 0xFF), (uint8_t)((color >> 8) & 0xFF), (uint8_t)((color >> 16) & 0xFF)};
+    for (int row = r.y; row < r.y + r.height; ++row) {
+        uint8_t* d = (uint8_t*)img.ptr + ((size_t)row * img.wstride + r.x) * 3;
+        for (int col = 0; col < r.width; ++col, d += 3) memcpy(d, px, 3);
+    }
+}
+
+void FramePyramid::disable_level(PyramidLevel level) {
+    enabled_[level] = false;
+}
+
+bool FramePyramid::cpu_capable(int level, const RgaImage& src) const {
+    if (!has_region_[level]) return cpu_convert_supported(src, levels_[level]);
+    // letterbox 的 CPU 路径只支持 RGB888 目标
+    if (levels_[level].format != RK_FORMAT_RGB_888) return false;
+    return cpu_convert_supported(src, sub_image(levels_[level], regions_[level]));
+}
+
+// CPU 转换一层：源只读、目标只写，前后做 dma-buf 缓存同步
+int FramePyramid::convert_on_cpu(int level, const RgaImage& src) {
+    if (!cpu_capable(level, src)) return -1;
+    const RgaImage& dst = levels_[level];
+    DmaBufCpuAccess src_access(src.fd, DMA_BUF_SYNC_READ);
+    DmaBufCpuAccess dst_access(dst.fd, DMA_BUF_SYNC_WRITE);
+    if (!has_region_[level]) return cpu_convert_image(src, dst, CPU_ISA_AUTO, &cpu_cache_[level]);
+
+    if (pad_pending_[level]) {
+        im_rect pads[4];
+        int n = pad_rects(dst, regions_[level], pads);
+        for (int i = 0; i < n; ++i) fill_rgb(dst, pads[i], pad_colors_[level]);
+        pad_pending_[level] = false;
+    }
+    return cpu_convert_image(src, sub_image(dst, regions_[level]), CPU_ISA_AUTO, &cpu_cache_[level]);
+}
+
+int FramePyramid::submit(const RgaImage& src, uint32_t sequence) {
+    job_.wait();   // 上一帧的还没等的话先等完
+    src_ = src;
+    sequence_ = sequence;
+
+    // 先把 RGA 的层提交出去，CPU 的层趁 RGA 干活的时候做
+    bool has_cpu = false;
+    for (int i = 0; i < PYRAMID_LEVEL_COUNT; ++i) {
+        on_rga_[i] = false;
+        if (!enabled_[i]) continue;
+        if (cpu_[i] && cpu_capable(i, src)) {
+            has_cpu = true;
+            continue;
+        }
+        if (has_region_[i]) {
+            // letterbox：第一次顺便填充边框，缩放和填充在同一个 job 里
+            if (pad_pending_[i]) {
+                im_rect pads[4];
+                int n = pad_rects(levels_[i], regions_[i], pads);
+                for (int k = 0; k < n; ++k) job_.add_fill(levels_[i], pads[k], pad_colors_[i]);
+            }
+            im_rect srect = {0, 0, src.width, src.height};
+            job_.add_process(src, levels_[i], srect, regions_[i], 0);
+        } else {
+            job_.add_convert(src, levels_[i]);
+        }
+        on_rga_[i] = true;
+    }
+    job_.submit();   // RGA 出错的话 wait() 里处理
+
+    int ret = 0;
+    if (has_cpu) {
+        for (int i = 0; i < PYRAMID_LEVEL_COUNT; ++i) {
+            if (enabled_[i] && !on_rga_[i] && convert_on_cpu(i, src) < 0) ret = -1;
+        }
+    }
+    return ret;
+}
+
+int FramePyramid::wait() {
+    if (job_.wait() == 0) {
+        // RGA 的层 (包括填充) 都做完了
+        for (int i = 0; i < PYRAMID_LEVEL_COUNT; ++i) {
+            if (on_rga_[i]) pad_pending_[i] = false;
+            on_rga_[i] = false;
+        }
+        return 0;
+    }
+
+    // RGA 失败：CPU 能做的层补做，做不了的只能报错
+    if (!rga_error_logged_) {
+        cerr << ">>[Pyramid] RGA 转换失败，改用 CPU (" << cpu_isa_name(CPU_ISA_AUTO) << ")" << endl;
+        rga_error_logged_ = true;
+    }
+    int ret = 0;
+    for (int i = 0; i < PYRAMID_LEVEL_COUNT; ++i) {
+        if (!on_rga_[i]) continue;
+        on_rga_[i] = false;
+        if (convert_on_cpu(i, src_) < 0) ret = -1;
+    }
+    return ret;
+}
@@ -0,0 +1,43 @@
+#include "video/frame_source.h"
+#include <time.h>
+#include <cerrno>
+
+void FramePacer::reset(int fps, bool paced) {
+    paced_ = paced;
+    period_us_ = (fps > 0) ? 1000000 / fps : 33333;
+    next_us_ = now_us();
+}
+
+bool FramePacer::wait(int timeout_ms) {
+    if (!paced_) return true;
+
+    int64_t now = now_us();
+    int64_t wait_us = next_us_ - now;
+    if (wait_us > (int64_t)timeout_ms * 1000) {
+        // 还没到点，先睡满超时时间，让调用方有机会检查退出标志
+        struct timespec ts = {timeout_ms / 1000, (long)(timeout_ms % 1000) * 1000000};
+        while (nanosleep(&ts, &ts) < 0 && errno == EINTR) {}
+        return false;
+    }
+
+    if (wait_us > 0) {
+        // 用绝对时间睡，避免误差越积越多
+        struct timespec ts;
+        ts.tv_sec = next_us_ / 1000000;
+        ts.tv_nsec = (next_us_ % 1000000) * 1000;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+        next_us_ += period_us_;
+    } else if (-wait_us > period_us_ * 2) {
+        // 下游太慢落后太多，不补帧，从现在重新计时
+        next_us_ = now + period_us_;
+    } else {
+        next_us_ += period_us_;
+    }
+    return true;
+}
+
+int64_t FramePacer::now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
@@ -0,0 +1,71 @@
+#include "video/h264_nal.h"
+#include <cstring>
+
+// 找下一个起始码 (00 00 01 或 00 00 00 01)
+// 返回 NAL 头的位置，sc_len 是起始码长度；找不到返回 size
+static size_t find_start_code(const uint8_t* data, size_t size, size_t from, size_t* sc_len) {
+    for (size_t i = from; i + 3 <= size; ++i) {
+        if (data[i] != 0 || data[i + 1] != 0) continue;
+        if (data[i + 2] == 1) {
+            *sc_len = 3;
+            return i + 3;
+        }
+        if (i + 4 <= size && data[i + 2] == 0 && data[i + 3] == 1) {
+            *sc_len = 4;
+            return i + 4;
+        }
+    }
+    return size;
+}
+
+// 遍历每个 NAL：fn(nal_type, nal 起始, nal 长度)
+template <typename Fn>
+static bool for_each_nal(const uint8_t* data, size_t size, Fn fn) {
+    size_t sc_len = 0;
+    size_t nal = find_start_code(data, size, 0, &sc_len);
+    if (nal >= size) return false;
+
+    while (nal < size) {
+        size_t next_sc_len = 0;
+        size_t next = find_start_code(data, size, nal, &next_sc_len);
+        size_t end = (next < size) ? next - next_sc_len : size;
+        // 去掉尾部的 0 (trailing_zero_8bits，或者下一个 4 字节起始码多出来的那个 0)
+        while (end > nal && data[end - 1] == 0) end--;
+        if (end > nal) fn(data[nal] & 0x1f, data + nal, end - nal);
+        nal = next;
+    }
+    return true;
+}
+
+bool h264_scan_au(const uint8_t* data, size_t size, H264AuInfo* info) {
+    *info = H264AuInfo();
+    return for_each_nal(data, size, [info](int type, const uint8_t*, size_t) {
+        info->nal_count++;
+        if (type == H264_NAL_IDR) info->has_idr = true;
+        else if (type == H264_NAL_SPS) info->has_sps = true;
+        else if (type == H264_NAL_PPS) info->has_pps = true;
+    });
+}
+
+void H264ParamSets::update(const uint8_t* data, size_t size) {
+    for_each_nal(data, size, [this](int type, const uint8_t* nal, size_t len) {
+        if (type == H264_NAL_SPS) sps_.assign(nal, nal + len);
+        else if (type == H264_NAL_PPS) pps_.assign(nal, nal + len);
+    });
+}
+
+size_t H264ParamSets::header_size() const {
+    if (!ready()) return 0;
+    return 4 + sps_.size() + 4 + pps_.size();
+}
+
+size_t H264ParamSets::write_header(uint8_t* dst) const {
+    if (!ready()) return 0;
+    static const uint8_t START_CODE[4] = {0, 0, 0, 1};
+    uint8_t* p = dst;
+    memcpy(p, START_CODE, 4);            p += 4;
+    memcpy(p, sps_.data(), sps_.size()); p += sps_.size();
+    memcpy(p, START_CODE, 4);            p += 4;
+    memcpy(p, pps_.data(), pps_.size()); p += pps_.size();
+    return p - dst;
+}
@@ -132,21 +132,30 @@ int MppEncoder::encode(FILE* out_fp) {
     return -1; 
 }
 
-int MppEncoder::encode_to_memory(void** out_data, size_t* out_len, bool* is_key) {
-    if (!ctx || !mpi || !shared_input_buf) return -1;
+int MppEncoder::encode_to_memory(PacketBuffer* out_data, size_t* out_len, bool* is_key) {
+    return encode_buffer(shared_input_buf, out_data, out_len, is_key);
+}
+
+int MppEncoder::encode_pool_to_memory(int index, PacketBuffer* out_data, size_t* out_len, bool* is_key) {
+    if (index < 0 || index >= (int)input_pool.size()) return -1;
+    return encode_buffer(input_pool[index], out_data, out_len, is_key);
+}
+
+int MppEncoder::encode_buffer(MppBuffer input, PacketBuffer* out_data, size_t* out_len, bool* is_key) {
+    if (!ctx || !mpi || !input) return -1;
 
     MPP_RET ret = MPP_OK;
     MppFrame frame = nullptr;
     MppPacket packet = nullptr;
 
-    // 1. 包装 Frame (复用 shared_input_buf)
+    // 1. 包装 Frame (shared_input_buf 或输入池里的一块)
     mpp_frame_init(&frame);
     mpp_frame_set_width(frame, width);
     mpp_frame_set_height(frame, height);
     mpp_frame_set_hor_stride(frame, MPP_ALIGN(width, 16));
     mpp_frame_set_ver_stride(frame, MPP_ALIGN(height, 16));
     mpp_frame_set_fmt(frame, MPP_FMT_YUV420SP);
-    mpp_frame_set_buffer(frame, shared_input_buf);
+    mpp_frame_set_buffer(frame, input);
     mpp_frame_set_eos(frame, 0);
 
     // 2. 送入编码器
@@ -164,42 +173,38 @@ int MppEncoder::encode_to_memory(void** out_data, size_t* out_len, bool* is_key)
     if (ret == MPP_OK && packet) {
         void* ptr = mpp_packet_get_pos(packet);
         size_t len = mpp_packet_get_length(packet);
-        
+
+        out_data->reset();
+        *out_len = 0;
+
         //  检查是否是结束包或空包
         if (len > 0) {
-            // 深拷贝！
-            // 因为我们要马上调用 mpp_packet_deinit，所以必须把数据拷出来
-            *out_data = malloc(len); // 分配新内存
-            if (*out_data) {
-                memcpy(*out_data, ptr, len);
+            // 唯一的一次拷贝：马上要 mpp_packet_deinit，必须把数据拷出来
+            // 之后推流/录像队列共享这块内存，不再复制
+            std::shared_ptr<uint8_t> buf = alloc_packet_buffer(len);
+            if (buf) {
+                memcpy(buf.get(), ptr, len);
+                *out_data = buf;
                 *out_len = len;
                 if (is_key) {
-                MppMeta meta = mpp_packet_get_meta(packet);
-                RK_S32 is_intra = 0;
-                
-                // 从元数据中读取 "OUTPUT_INTRA" 标记
-                if (meta) {
-                    mpp_meta_get_s32(meta, KEY_OUTPUT_INTRA, &is_intra);
+                    MppMeta meta = mpp_packet_get_meta(packet);
+                    RK_S32 is_intra = 0;
+
+                    // 从元数据中读取 "OUTPUT_INTRA" 标记
+                    if (meta) {
+                        mpp_meta_get_s32(meta, KEY_OUTPUT_INTRA, &is_intra);
+                    }
+
+                    // 如果是 IDR 帧，MPP 会把 is_intra 置为 1
+                    *is_key = (is_intra != 0);
                 }
-                
-                // 如果是 IDR 帧，MPP 会把 is_intra 置为 1
-                *is_key = (is_intra != 0);
             }
-            } else {
-                *out_len = 0;
-            }
-        } else {
-            *out_data = nullptr;
-            *out_len = 0;
         }
 
         // 归还 Packet 给 MPP
         mpp_packet_deinit(&packet); 
         
         return (*out_len > 0) ? 0 : -1;
-        
-       
-        return 0;
     }
 
     return -1; 
@@ -211,8 +216,64 @@ void* MppEncoder::get_input_ptr() {
     }
     return nullptr;
 }
+int MppEncoder::alloc_input_pool(int count, int* out_fds) {
+    if (!ctx || count <= 0 || !out_fds) return -1;
+
+    // 单独一个 DRM 内存组，和 shared_input_buf 分开管理
+    MPP_RET ret = mpp_buffer_group_get_internal(&input_group, MPP_BUFFER_TYPE_DRM);
+    if (ret != MPP_OK) { cerr << "mpp buffer group alloc failed" << endl; return -1; }
+
+    size_t frame_size = get_frame_size();
+    for (int i = 0; i < count; ++i) {
+        MppBuffer buf = nullptr;
+        ret = mpp_buffer_get(input_group, &buf, frame_size);
+        if (ret != MPP_OK) {
+            cerr << "mpp input pool alloc failed at " << i << endl;
+            return -1;
+        }
+        input_pool.push_back(buf);
+        out_fds[i] = mpp_buffer_get_fd(buf);
+    }
+
+    cout << ">>[MPP] 输入池分配成功: " << count << " x " << frame_size << endl;
+    return 0;
+}
+
+int MppEncoder::get_pool_fd(int index) const {
+    if (index < 0 || index >= (int)input_pool.size()) return -1;
+    return mpp_buffer_get_fd(input_pool[index]);
+}
+
+void* MppEncoder::get_pool_ptr(int index) {
+    if (index < 0 || index >= (int)input_pool.size()) return nullptr;
+    return mpp_buffer_get_ptr(input_pool[index]);
+}
+
+int MppEncoder::get_hor_stride() const {
+    return MPP_ALIGN(width, 16);
+}
+
+int MppEncoder::get_ver_stride() const {
+    return MPP_ALIGN(height, 16);
+}
+
+size_t MppEncoder::get_frame_size() const {
+    return (size_t)get_hor_stride() * get_ver_stride() * 3 / 2;
+}
+
 void MppEncoder::deinit() {
+    // 先丢掉 RGA 缓存的句柄，fd 号之后可能被别的 buffer 复用
+    for (MppBuffer buf : input_pool) {
+        rga_release_fd(mpp_buffer_get_fd(buf));
+        mpp_buffer_put(buf);
+    }
+    input_pool.clear();
+    if (input_group) {
+        mpp_buffer_group_put(input_group);
+        input_group = nullptr;
+    }
     if (shared_input_buf) {
+        rga_release_fd(mpp_buffer_get_fd(shared_input_buf));
         mpp_buffer_put(shared_input_buf);
         shared_input_buf = nullptr;
     }
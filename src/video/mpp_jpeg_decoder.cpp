@@ -0,0 +1,178 @@
+#include "video/mpp_jpeg_decoder.h"
+#include "video/rga.h"
+#include <iostream>
+#include <cstring>
+
+using namespace std;
+
+// 向上对齐宏 (16字节对齐)
+#define MPP_ALIGN(x, a) (((x)+(a)-1)&~((a)-1))
+
+MppJpegDecoder::MppJpegDecoder() {}
+
+MppJpegDecoder::~MppJpegDecoder() {
+    deinit();
+}
+
+int MppJpegDecoder::init(int width, int height, int slot_count) {
+    width_ = width;
+    height_ = height;
+    hor_stride_ = MPP_ALIGN(width, 16);
+    ver_stride_ = MPP_ALIGN(height, 16);
+
+    MPP_RET ret = MPP_OK;
+
+    // 1. 创建解码上下文
+    ret = mpp_create(&ctx_, &mpi_);
+    if (ret != MPP_OK) { cerr << ">>[MJPEG] mpp_create failed" << endl; return -1; }
+
+    ret = mpp_init(ctx_, MPP_CTX_DEC, MPP_VIDEO_CodingMJPEG);
+    if (ret != MPP_OK) { cerr << ">>[MJPEG] mpp_init failed" << endl; return -1; }
+
+    // 2. 要求输出 NV12 (和编码器输入一致)；不支持转换的芯片会按 JPEG 原始采样输出，decode 里再看
+    MppFrameFormat out_fmt = MPP_FMT_YUV420SP;
+    if (mpi_->control(ctx_, MPP_DEC_SET_OUTPUT_FORMAT, &out_fmt) != MPP_OK) {
+        cout << ">>[MJPEG] 解码器不支持设置输出格式，使用 JPEG 原始采样格式" << endl;
+    }
+
+    // 一帧进一帧出，取帧时阻塞等硬件做完
+    MppPollType timeout = MPP_POLL_BLOCK;
+    mpi_->control(ctx_, MPP_SET_OUTPUT_TIMEOUT, &timeout);
+
+    // 3. 码流内存：先按一帧 NV12 的大小给，遇到更大的 JPEG 再换
+    ret = mpp_buffer_group_get_internal(&packet_group_, MPP_BUFFER_TYPE_DRM);
+    if (ret != MPP_OK) { cerr << ">>[MJPEG] packet group alloc failed" << endl; return -1; }
+    packet_size_ = (size_t)hor_stride_ * ver_stride_;
+    ret = mpp_buffer_get(packet_group_, &packet_buf_, packet_size_);
+    if (ret != MPP_OK) { cerr << ">>[MJPEG] packet buffer alloc failed" << endl; return -1; }
+
+    // 4. 输出内存：按 4:2:2 的大小分配，硬件没做格式转换时也放得下
+    ret = mpp_buffer_group_get_internal(&frame_group_, MPP_BUFFER_TYPE_DRM);
+    if (ret != MPP_OK) { cerr << ">>[MJPEG] frame group alloc failed" << endl; return -1; }
+    size_t frame_size = (size_t)hor_stride_ * ver_stride_ * 2;
+    for (int i = 0; i < slot_count; ++i) {
+        MppBuffer buf = nullptr;
+        ret = mpp_buffer_get(frame_group_, &buf, frame_size);
+        if (ret != MPP_OK) {
+            cerr << ">>[MJPEG] frame buffer alloc failed at " << i << endl;
+            return -1;
+        }
+        frame_bufs_.push_back(buf);
+    }
+
+    printf(">>[MJPEG] MPP 硬件解码器初始化成功: %dx%d (stride %dx%d) | %d 块输出内存\n",
+           width, height, hor_stride_, ver_stride_, slot_count);
+    return 0;
+}
+
+int MppJpegDecoder::decode(const void* data, size_t size, int slot, DecodedFrame* out) {
+    if (!ctx_ || !mpi_ || slot < 0 || slot >= (int)frame_bufs_.size()) return -1;
+    if (!data || size == 0) return -1;
+
+    MPP_RET ret = MPP_OK;
+
+    // 1. JPEG 拷进码流内存 (偶尔有特别大的帧，换一块更大的)
+    if (size > packet_size_) {
+        mpp_buffer_put(packet_buf_);
+        packet_buf_ = nullptr;
+        packet_size_ = MPP_ALIGN(size, 4096);
+        if (mpp_buffer_get(packet_group_, &packet_buf_, packet_size_) != MPP_OK) {
+            cerr << ">>[MJPEG] packet buffer realloc failed" << endl;
+            packet_size_ = 0;
+            return -1;
+        }
+    }
+    memcpy(mpp_buffer_get_ptr(packet_buf_), data, size);
+
+    MppPacket packet = nullptr;
+    mpp_packet_init_with_buffer(&packet, packet_buf_);
+    mpp_packet_set_length(packet, size);
+
+    // 2. 指定输出内存：通过 packet 的 meta 把空 frame 挂上去，硬件直接解到这个 slot
+    MppFrame frame = nullptr;
+    mpp_frame_init(&frame);
+    mpp_frame_set_buffer(frame, frame_bufs_[slot]);
+    MppMeta meta = mpp_packet_get_meta(packet);
+    if (meta) mpp_meta_set_frame(meta, KEY_OUTPUT_FRAME, frame);
+
+    // 3. 送码流，取结果
+    ret = mpi_->decode_put_packet(ctx_, packet);
+    if (ret != MPP_OK) {
+        cerr << ">>[MJPEG] decode_put_packet error: " << ret << endl;
+        mpp_packet_deinit(&packet);
+        mpp_frame_deinit(&frame);
+        return -1;
+    }
+
+    MppFrame out_frame = nullptr;
+    ret = mpi_->decode_get_frame(ctx_, &out_frame);
+    mpp_packet_deinit(&packet);
+    if (ret != MPP_OK || !out_frame) {
+        cerr << ">>[MJPEG] decode_get_frame error: " << ret << endl;
+        mpp_frame_deinit(&frame);
+        return -1;
+    }
+
+    // 坏帧 (USB 传输出错，JPEG 不完整) 直接丢掉
+    bool broken = mpp_frame_get_errinfo(out_frame) || mpp_frame_get_discard(out_frame);
+    MppFrameFormat fmt = (MppFrameFormat)(mpp_frame_get_fmt(out_frame) & MPP_FRAME_FMT_MASK);
+
+    out->dma_fd = mpp_buffer_get_fd(frame_bufs_[slot]);
+    out->virt = mpp_buffer_get_ptr(frame_bufs_[slot]);
+    out->width = mpp_frame_get_width(out_frame);
+    out->height = mpp_frame_get_height(out_frame);
+    out->hor_stride = mpp_frame_get_hor_stride(out_frame);
+    out->ver_stride = mpp_frame_get_ver_stride(out_frame);
+
+    // out_frame 就是挂上去的那个 frame，释放一次就够了
+    if (out_frame != frame) mpp_frame_deinit(&frame);
+    mpp_frame_deinit(&out_frame);
+
+    if (broken) return -1;
+
+    if (fmt == MPP_FMT_YUV420SP) {
+        out->format = RK_FORMAT_YCbCr_420_SP;
+    } else if (fmt == MPP_FMT_YUV422SP) {
+        // 硬件没做格式转换，JPEG 本身是 4:2:2 采样，让 RGA 转
+        out->format = RK_FORMAT_YCbCr_422_SP;
+        if (!warned_format_) {
+            cout << ">>[MJPEG] 解码输出为 NV16，由 RGA 转 NV12" << endl;
+            warned_format_ = true;
+        }
+    } else {
+        if (!warned_format_) {
+            cerr << ">>[MJPEG] 不支持的解码输出格式: " << fmt << endl;
+            warned_format_ = true;
+        }
+        return -1;
+    }
+    return 0;
+}
+
+int MppJpegDecoder::get_format() const {
+    return RK_FORMAT_YCbCr_420_SP;
+}
+
+void MppJpegDecoder::deinit() {
+    for (MppBuffer buf : frame_bufs_) {
+        rga_release_fd(mpp_buffer_get_fd(buf));
+        mpp_buffer_put(buf);
+    }
+    frame_bufs_.clear();
+    if (frame_group_) {
+        mpp_buffer_group_put(frame_group_);
+        frame_group_ = nullptr;
+    }
+    if (packet_buf_) {
+        mpp_buffer_put(packet_buf_);
+        packet_buf_ = nullptr;
+    }
+    if (packet_group_) {
+        mpp_buffer_group_put(packet_group_);
+        packet_group_ = nullptr;
+    }
+    if (ctx_) {
+        mpp_destroy(ctx_);
+        ctx_ = nullptr;
+    }
+}
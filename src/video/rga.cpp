@@ -1,8 +1,13 @@
 #include "video/rga.h"
+#include "video/rga_job.h"
 #include "video/v4l2.h"
 #include "video/mpp_encoder.h"
 #include <iostream>
 #include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <sys/stat.h>
 
 using namespace std;
 
@@ -15,18 +20,193 @@ int init_rga() {
 }
 
 
+// ---------------------------------------------------------------- 句柄缓存
+
+namespace {
+
+// 缓存上限：常驻的内存 (编码器输入池、采集缓冲、金字塔、OSD 图层) 多路加起来也就几十块；
+// 超过上限按最久没用的淘汰。虚拟地址的上限小一些：文件回放每帧是大映射里的一个偏移，
+// 导入一次就锁住那一帧的页，不设上限的话整个回放文件都会被钉在内存里。
+// 正在跑的 job 用的句柄总是最近用过的，不会被淘汰。
+const size_t MAX_FD_HANDLES = 128;
+const size_t MAX_VIRT_HANDLES = 32;
+
+struct CachedHandle {
+    rga_buffer_handle_t handle;
+    size_t size;
+    ino_t ino;   // dma-buf 的 inode (fd 号会被复用，inode 不会)；虚拟地址为 0
+};
+
+// 按最近使用排序的句柄表，表头是最近用过的
+template <typename Key>
+struct LruHandles {
+    explicit LruHandles(size_t cap) : capacity(cap) {}
+
+    using Order = std::list<std::pair<Key, CachedHandle>>;
+    using Index = std::unordered_map<Key, typename Order::iterator>;
+
+    size_t capacity;
+    Order order;
+    Index index;
+
+    // 释放句柄并从表里删掉
+    void erase(typename Index::iterator it) {
+        releasebuffer_handle(it->second->second.handle);
+        order.erase(it->second);
+        index.erase(it);
+    }
+};
+
+struct HandleCache {
+    std::mutex mtx;
+    LruHandles<int> fds{MAX_FD_HANDLES};
+    LruHandles<void*> virts{MAX_VIRT_HANDLES};
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+};
+
+HandleCache& handle_cache() {
+    static HandleCache cache;
+    return cache;
+}
+
+// 缓存里有、而且还是同一块内存 (inode 相同、大小够) 就直接用；
+// 否则 (fd 号被别的 buffer 复用了、虚拟地址换了一块更大的内存) 释放旧句柄重新导入
+template <typename Key, typename ImportFn>
+rga_buffer_handle_t lookup_or_import(LruHandles<Key>& lru, Key key, size_t size, ino_t ino, ImportFn import) {
+    HandleCache& cache = handle_cache();
+    std::lock_guard<std::mutex> lock(cache.mtx);
+    auto it = lru.index.find(key);
+    if (it != lru.index.end()) {
+        const CachedHandle& cached = it->second->second;
+        if (cached.ino == ino && cached.size >= size) {
+            ++cache.hits;
+            lru.order.splice(lru.order.begin(), lru.order, it->second);
+            return cached.handle;
+        }
+        lru.erase(it);
+    }
+    ++cache.misses;
+    rga_buffer_handle_t handle = import();
+    if (handle == 0) return 0;
+    lru.order.emplace_front(key, CachedHandle{handle, size, ino});
+    lru.index[key] = lru.order.begin();
+    while (lru.order.size() > lru.capacity) {
+        lru.erase(lru.index.find(lru.order.back().first));
+        ++cache.evictions;
+    }
+    return handle;
+}
+
+// 按格式算一帧的字节数，不认识的格式返回 0 (不走缓存)
+size_t frame_bytes(int wstride, int hstride, int fmt) {
+    size_t pixels = (size_t)wstride * hstride;
+    switch (fmt) {
+    case RK_FORMAT_YCbCr_420_SP:
+    case RK_FORMAT_YCrCb_420_SP:
+        return pixels * 3 / 2;
+    case RK_FORMAT_YUYV_422:
+    case RK_FORMAT_UYVY_422:
+        return pixels * 2;
+    case RK_FORMAT_RGB_888:
+    case RK_FORMAT_BGR_888:
+        return pixels * 3;
+    case RK_FORMAT_RGBA_8888:
+    case RK_FORMAT_BGRA_8888:
+        return pixels * 4;
+    default:
+        return 0;
+    }
+}
+
+// 优先用缓存的句柄，导入失败就退回每次 wrap
+rga_buffer_t wrap_cached(void* ptr, int fd, int w, int h, int wstride, int hstride, int fmt) {
+    size_t size = frame_bytes(wstride, hstride, fmt);
+    rga_buffer_handle_t handle = 0;
+    if (size > 0) handle = (fd > 0) ? rga_import_fd(fd, size) : rga_import_virt(ptr, size);
+    if (handle) return wrapbuffer_handle_t(handle, w, h, wstride, hstride, fmt);
+    if (fd > 0) return wrapbuffer_fd_t(fd, w, h, wstride, hstride, fmt);
+    return wrapbuffer_virtualaddr_t(ptr, w, h, wstride, hstride, fmt);
+}
+
+} // namespace
+
+rga_buffer_handle_t rga_import_fd(int fd, size_t size) {
+    if (fd < 0 || size == 0) return 0;
+    // 每次都 fstat 一下 (比重新导入便宜得多)，fd 号被关闭后复用时 inode 对不上，不会拿到旧句柄
+    struct stat st;
+    if (fstat(fd, &st) < 0) return 0;
+    return lookup_or_import(handle_cache().fds, fd, size, st.st_ino,
+                            [&] { return importbuffer_fd(fd, (int)size); });
+}
+
+rga_buffer_handle_t rga_import_virt(void* ptr, size_t size) {
+    if (!ptr || size == 0) return 0;
+    return lookup_or_import(handle_cache().virts, ptr, size, (ino_t)0,
+                            [&] { return importbuffer_virtualaddr(ptr, (int)size); });
+}
+
+void rga_release_fd(int fd) {
+    HandleCache& cache = handle_cache();
+    std::lock_guard<std::mutex> lock(cache.mtx);
+    auto it = cache.fds.index.find(fd);
+    if (it != cache.fds.index.end()) cache.fds.erase(it);
+}
+
+void rga_release_virt(void* ptr) {
+    HandleCache& cache = handle_cache();
+    std::lock_guard<std::mutex> lock(cache.mtx);
+    auto it = cache.virts.index.find(ptr);
+    if (it != cache.virts.index.end()) cache.virts.erase(it);
+}
+
+void rga_release_virt_range(void* base, size_t size) {
+    HandleCache& cache = handle_cache();
+    std::lock_guard<std::mutex> lock(cache.mtx);
+    uint8_t* begin = (uint8_t*)base;
+    uint8_t* end = begin + size;
+    for (auto it = cache.virts.index.begin(); it != cache.virts.index.end();) {
+        uint8_t* p = (uint8_t*)it->first;
+        if (p >= begin && p < end) {
+            releasebuffer_handle(it->second->second.handle);
+            cache.virts.order.erase(it->second);
+            it = cache.virts.index.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+RgaCacheStats rga_cache_stats() {
+    HandleCache& cache = handle_cache();
+    std::lock_guard<std::mutex> lock(cache.mtx);
+    return {cache.hits, cache.misses, cache.evictions, cache.fds.order.size() + cache.virts.order.size()};
+}
+
+// ---------------------------------------------------------------- 转换
+
 int rga_convert(void* src_ptr, int src_fd, int src_w, int src_h, int src_fmt,
                 void* dst_ptr, int dst_fd, int dst_w, int dst_h, int dst_fmt) {
+    return rga_convert_stride(src_ptr, src_fd, src_w, src_h, src_w, src_h, src_fmt,
+                              dst_ptr, dst_fd, dst_w, dst_h, dst_fmt);
+}
 
-    rga_buffer_t src, dst;
-    
-    // 封装源 buffer
-    if (src_fd > 0) src = wrapbuffer_fd(src_fd, src_w, src_h, src_fmt);
-    else            src = wrapbuffer_virtualaddr(src_ptr, src_w, src_h, src_fmt);
+int rga_convert_stride(void* src_ptr, int src_fd, int src_w, int src_h, int src_wstride, int src_hstride, int src_fmt,
+                       void* dst_ptr, int dst_fd, int dst_w, int dst_h, int dst_fmt) {
 
-    // 封装目的 buffer
-    if (dst_fd > 0) dst = wrapbuffer_fd(dst_fd, dst_w, dst_h, dst_fmt);
-    else            dst = wrapbuffer_virtualaddr(dst_ptr, dst_w, dst_h, dst_fmt);
+    // 源和目的都用缓存的句柄 (30fps 下每帧省掉两次导入)
+    rga_buffer_t src = wrap_cached(src_ptr, src_fd, src_w, src_h, src_wstride, src_hstride, src_fmt);
+    rga_buffer_t dst = wrap_cached(dst_ptr, dst_fd, dst_w, dst_h, dst_w, dst_h, dst_fmt);
 
     return (imcvtcolor(src, dst, src.format, dst.format) == IM_STATUS_SUCCESS) ? 0 : -1; // 执行拷贝/缩放/格式转换
-}
\ No newline at end of file
+}
+rga_buffer_t rga_wrap(const RgaImage& img) {
+    return wrap_cached(img.ptr, img.fd, img.width, img.height, img.wstride, img.hstride, img.format);
+}
+
+int rga_convert_batch(const RgaImage& src, const RgaImage* dsts, int count) {
+    RgaJob job;
+    for (int i = 0; i < count; ++i) job.add_convert(src, dsts[i]);
+    return job.run();
+}
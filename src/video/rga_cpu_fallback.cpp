@@ -0,0 +1,29 @@
+#include "video/rga_cpu_fallback.h"
+
+bool cpu_convert_supported(const RgaImage& src, const RgaImage& dst) {
+    if (!src.ptr || !dst.ptr) return false;
+    if ((src.width | src.height | dst.width | dst.height) & 1) return false;
+    bool same_size = (src.width == dst.width && src.height == dst.height);
+    if (src.format == RK_FORMAT_YUYV_422 && dst.format == RK_FORMAT_YCbCr_420_SP) return same_size;
+    if (src.format == RK_FORMAT_RGB_888 && dst.format == RK_FORMAT_YCbCr_420_SP) return same_size;
+    if (src.format == RK_FORMAT_YCbCr_420_SP && dst.format == RK_FORMAT_RGB_888) return true;
+    return false;
+}
+
+int cpu_convert_image(const RgaImage& src, const RgaImage& dst, CpuIsa isa, CpuScaleCache* cache) {
+    if (!cpu_convert_supported(src, dst)) return -1;
+    const uint8_t* s = (const uint8_t*)src.ptr;
+    uint8_t* d = (uint8_t*)dst.ptr;
+
+    if (src.format == RK_FORMAT_YUYV_422) {
+        cpu_yuyv_to_nv12(s, src.wstride * 2, src.width, src.height,
+                         d, dst.wstride, d + (size_t)dst.wstride * dst.hstride, dst.wstride, isa);
+    } else if (src.format == RK_FORMAT_RGB_888) {
+        cpu_rgb_to_nv12(s, src.wstride * 3, src.width, src.height,
+                        d, dst.wstride, d + (size_t)dst.wstride * dst.hstride, dst.wstride, isa);
+    } else {
+        cpu_nv12_to_rgb(s, src.wstride, s + (size_t)src.wstride * src.hstride, src.wstride,
+                        src.width, src.height, d, dst.wstride * 3, dst.width, dst.height, isa, cache);
+    }
+    return 0;
+}
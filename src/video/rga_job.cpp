@@ -0,0 +1,136 @@
+#include "video/rga_job.h"
+#include <iostream>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+
+using namespace std;
+
+RgaJob::RgaJob() {}
+
+RgaJob::~RgaJob() {
+    if (submitted_) wait();
+}
+
+void RgaJob::add_convert(const RgaImage& src, const RgaImage& dst) {
+    im_rect srect = {0, 0, src.width, src.height};
+    im_rect drect = {0, 0, dst.width, dst.height};
+    add_process(src, dst, srect, drect, 0);
+}
+
+void RgaJob::add_process(const RgaImage& src, const RgaImage& dst, const im_rect& srect, const im_rect& drect,
+                         int usage) {
+    Task task;
+    task.src = rga_wrap(src);
+    task.dst = rga_wrap(dst);
+    task.srect = srect;
+    task.drect = drect;
+    task.usage = usage;
+    task.fill = false;
+    task.color = 0;
+    tasks_.push_back(task);
+}
+
+void RgaJob::add_fill(const RgaImage& dst, const im_rect& rect, uint32_t color) {
+    Task task;
+    memset(&task, 0, sizeof(task));
+    task.dst = rga_wrap(dst);
+    task.drect = rect;
+    task.fill = true;
+    task.color = color;
+    tasks_.push_back(task);
+}
+
+int RgaJob::submit(Callback on_done) {
+    if (submitted_) wait();
+    on_done_ = on_done;
+    result_ = 0;
+    submitted_ = true;
+    if (tasks_.empty()) {
+        finish(0);
+        return 0;
+    }
+
+    im_job_handle_t job = imbeginJob();
+    if (job <= 0) {
+        // 老版本 librga：逐个同步执行
+        int ret = run_sync();
+        finish(ret);
+        return ret;
+    }
+
+    rga_buffer_t pat;
+    memset(&pat, 0, sizeof(pat));
+    im_rect prect;
+    memset(&prect, 0, sizeof(prect));
+    for (const Task& t : tasks_) {
+        im_opt_t opt;
+        memset(&opt, 0, sizeof(opt));
+        IM_STATUS status = t.fill ? imfillTask(job, t.dst, t.drect, t.color)
+                                  : improcessTask(job, t.src, t.dst, pat, t.srect, t.drect, prect, &opt, t.usage);
+        if (status != IM_STATUS_SUCCESS) {
+            imcancelJob(job);
+            finish(-1);
+            return -1;
+        }
+    }
+
+    int fence = -1;
+    if (imendJob(job, IM_ASYNC, 0, &fence) != IM_STATUS_SUCCESS) {
+        finish(-1);
+        return -1;
+    }
+    // 驱动没给 fence 说明已经同步做完了
+    if (fence < 0) {
+        finish(0);
+        return 0;
+    }
+    fence_fd_ = fence;
+    return 0;
+}
+
+int RgaJob::wait(int timeout_ms) {
+    if (!submitted_) return result_;
+    if (fence_fd_ >= 0) {
+        struct pollfd pfd = {fence_fd_, POLLIN, 0};
+        int ret = ::poll(&pfd, 1, timeout_ms);
+        if (ret == 0) return -1;   // 超时，还没做完
+        finish((ret > 0 && !(pfd.revents & (POLLERR | POLLNVAL))) ? 0 : -1);
+    }
+    return result_;
+}
+
+bool RgaJob::poll() {
+    if (!submitted_) return true;
+    wait(0);
+    return !submitted_;
+}
+
+int RgaJob::run_sync() {
+    rga_buffer_t pat;
+    memset(&pat, 0, sizeof(pat));
+    im_rect prect;
+    memset(&prect, 0, sizeof(prect));
+    for (Task& t : tasks_) {
+        IM_STATUS status = t.fill ? imfill(t.dst, t.drect, t.color)
+                                  : improcess(t.src, t.dst, pat, t.srect, t.drect, prect, t.usage);
+        if (status != IM_STATUS_SUCCESS) return -1;
+    }
+    return 0;
+}
+
+// 收尾：关 fence，清空任务，执行回调
+void RgaJob::finish(int result) {
+    if (fence_fd_ >= 0) {
+        close(fence_fd_);
+        fence_fd_ = -1;
+    }
+    tasks_.clear();
+    submitted_ = false;
+    result_ = result;
+    if (on_done_) {
+        Callback cb;
+        cb.swap(on_done_);
+        cb(result);
+    }
+}
@@ -0,0 +1,135 @@
+#include "video/synthetic_source.h"
+#include "video/rga.h"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+// 8 条彩条的 UV 值 (白/黄/青/绿/品红/红/蓝/黑)
+static const uint8_t BAR_UV[8][2] = {
+    {128, 128}, {16, 146}, {166, 16}, {54, 34},
+    {202, 222}, {90, 240}, {240, 110}, {128, 128},
+};
+
+SyntheticFrameSource::SyntheticFrameSource(bool paced, int buffer_count)
+    : paced_(paced), buffers_(buffer_count, nullptr), in_use_(buffer_count, false) {}
+
+SyntheticFrameSource::~SyntheticFrameSource() {
+    stop();
+    for (uint8_t*& buf : buffers_) {
+        rga_release_virt(buf);
+        free(buf);
+        buf = nullptr;
+    }
+}
+
+int SyntheticFrameSource::open(int width, int height, int fps) {
+    width_ = width;
+    height_ = height;
+    fps_ = fps;
+    frame_size_ = (size_t)width * height * 3 / 2;
+
+    for (uint8_t*& buf : buffers_) {
+        // 按 64 字节对齐，RGA 走虚拟地址时更友好
+        if (posix_memalign((void**)&buf, 64, frame_size_) != 0) {
+            buf = nullptr;
+            cerr << ">>[Synthetic] 内存分配失败" << endl;
+            return -1;
+        }
+
+        // UV 平面是固定的彩条，只画一次
+        uint8_t* uv = buf + (size_t)width * height;
+        for (int y = 0; y < height / 2; ++y) {
+            uint8_t* row = uv + (size_t)y * width;
+            for (int x = 0; x < width; x += 2) {
+                int bar = x * 8 / width;
+                row[x] = BAR_UV[bar][0];
+                row[x + 1] = BAR_UV[bar][1];
+            }
+        }
+    }
+
+    printf(">>[Synthetic] 合成测试图: %dx%d NV12 | %s\n",
+           width, height, paced_ ? "按帧率" : "全速");
+    return 0;
+}
+
+int SyntheticFrameSource::start() {
+    next_ = 0;
+    pacer_.reset(fps_, paced_);
+    running_ = true;
+    return 0;
+}
+
+void SyntheticFrameSource::stop() {
+    running_ = false;
+}
+
+bool SyntheticFrameSource::acquire(SourceFrame* frame, int timeout_ms) {
+    if (!running_) return false;
+    if (!pacer_.wait(timeout_ms)) return false;
+
+    // 找一块下游没拿着的 buffer
+    int count = (int)buffers_.size();
+    int index = -1;
+    for (int i = 0; i < count; ++i) {
+        int k = (next_ + i) % count;
+        if (!in_use_[k]) { index = k; break; }
+    }
+    if (index < 0) {
+        // 下游一块都没还，这一帧算跳过
+        skipped_++;
+        sequence_++;
+        return false;
+    }
+    next_ = (index + 1) % count;
+
+    render(buffers_[index], sequence_);
+    in_use_[index] = true;
+
+    frame->index = index;
+    frame->dma_fd = -1;
+    frame->virt = buffers_[index];
+    frame->size = frame_size_;
+    frame->format = RK_FORMAT_YCbCr_420_SP;
+    frame->hor_stride = width_;
+    frame->ver_stride = height_;
+    frame->info.index = index;
+    frame->info.timestamp_us = FramePacer::now_us();
+    frame->info.sequence = sequence_++;
+    frame->info.bytesused = frame_size_;
+    return true;
+}
+
+void SyntheticFrameSource::release(int index) {
+    if (index >= 0 && index < (int)in_use_.size()) in_use_[index] = false;
+}
+
+int SyntheticFrameSource::get_format() const {
+    return RK_FORMAT_YCbCr_420_SP;
+}
+
+void SyntheticFrameSource::render(uint8_t* buf, uint32_t n) {
+    // 1. 亮度：斜向渐变，每帧平移 4 个像素
+    uint8_t shift = (uint8_t)(n * 4);
+    for (int y = 0; y < height_; ++y) {
+        uint8_t* row = buf + (size_t)y * width_;
+        uint8_t base = (uint8_t)(y + shift);
+        for (int x = 0; x < width_; ++x) {
+            row[x] = (uint8_t)(base + x);
+        }
+    }
+
+    // 2. 白块：边长 1/8 高度，左右来回移动 (一个来回 2 秒)
+    int box = height_ / 8;
+    int range = width_ - box;
+    int period = fps_ > 0 ? fps_ * 2 : 60;
+    int phase = (int)(n % period);
+    int box_x = (phase < period / 2) ? phase * range * 2 / period
+                                     : (period - phase) * range * 2 / period;
+    int box_y = (height_ - box) / 2;
+    for (int y = box_y; y < box_y + box; ++y) {
+        memset(buf + (size_t)y * width_ + box_x, 235, box);
+    }
+}
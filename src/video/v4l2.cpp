@@ -10,28 +10,64 @@
 #include <vector>
 #include <sys/select.h>
 #include <sys/time.h>
+#include <time.h>
+#include <cerrno>
+#include <algorithm>
 #include "video/v4l2.h"
+#include "video/rga.h"
 
 
 using namespace std;
 
-int query_device_info(const char* dev_name) {
+// 按当前内存模式填好 v4l2_buffer (DMABUF 模式要带上 fd)
+void V4L2Device::fill_buffer(struct v4l2_buffer* buf, struct v4l2_plane* planes, int index) {
+    buf->type = buf_type_;
+    buf->memory = memory_;
+    buf->index = index;
 
-    int fd = open(dev_name, O_RDWR | O_NONBLOCK, 0);
-    if (fd < 0) {
+    int dma_fd = -1;
+    if (memory_ == V4L2_MEMORY_DMABUF && index >= 0 && index < (int)dmabuf_fds_.size()) {
+        dma_fd = dmabuf_fds_[index];
+    }
+
+    if (buf_type_ == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
+        buf->m.planes = planes;
+        buf->length = 1;
+        if (dma_fd >= 0) {
+            planes[0].m.fd = dma_fd;
+            planes[0].length = dmabuf_length_;
+        }
+    } else if (dma_fd >= 0) {
+        buf->m.fd = dma_fd;
+        buf->length = dmabuf_length_;
+    }
+}
+
+V4L2Device::V4L2Device() {}
+
+V4L2Device::~V4L2Device() {
+    close_device();
+}
+
+int V4L2Device::open_device(const char* dev_name) {
+
+    fd_ = open(dev_name, O_RDWR | O_NONBLOCK, 0);
+    if (fd_ < 0) {
         perror("无法打开摄像头");
         return -1;
     }
-    cout << "成功打开设备: " << dev_name << " (fd=" << fd << ")" << endl;
+    dev_name_ = dev_name;
+    cout << "成功打开设备: " << dev_name << " (fd=" << fd_ << ")" << endl;
 
     // 2. 查询设备能力 (Capability)
     struct v4l2_capability cap;
     memset(&cap, 0, sizeof(cap));
     
 
-    if (ioctl(fd, VIDIOC_QUERYCAP, &cap) < 0) {
+    if (ioctl(fd_, VIDIOC_QUERYCAP, &cap) < 0) {
         perror("查询设备能力失败");
-        close(fd);
+        close(fd_);
+        fd_ = -1;
         return -1;
     }
 
@@ -43,14 +79,15 @@ int query_device_info(const char* dev_name) {
                                   << ((cap.version >> 8) & 0xFF) << endl;
 
     if (cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE) {
-        g_buf_type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+        buf_type_ = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
         cout << ">>[V4L2] 设备类型: MIPI/ISP" << endl;
     } else if (cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) {
-        g_buf_type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf_type_ = V4L2_BUF_TYPE_VIDEO_CAPTURE;
         cout << ">>[V4L2] 设备类型: USB/UVC" << endl;
     } else {
         cout << ">>[V4L2] 不是视频采集设备" << endl;
-        close(fd);
+        close(fd_);
+        fd_ = -1;
         return -1;
     }
 
@@ -60,12 +97,13 @@ int query_device_info(const char* dev_name) {
 
     struct v4l2_fmtdesc fmt;
     memset(&fmt, 0, sizeof(fmt));
-    fmt.type = g_buf_type; // 指定我们查询的是视频捕获类型
+    fmt.type = buf_type_; // 指定我们查询的是视频捕获类型
+    modes_.clear();
 
     // 循环查询，index 从 0 开始递增，直到失败
     for (int i = 0; ; ++i) {
         fmt.index = i;
-        if (ioctl(fd, VIDIOC_ENUM_FMT, &fmt) < 0) {
+        if (ioctl(fd_, VIDIOC_ENUM_FMT, &fmt) < 0) {
             break; // 查询完了
         }
 
@@ -87,13 +125,32 @@ int query_device_info(const char* dev_name) {
         frmsize.pixel_format = fmt.pixelformat;
         frmsize.index = 0;
 
-        while (ioctl(fd, VIDIOC_ENUM_FRAMESIZES, &frmsize) == 0) {
+        while (ioctl(fd_, VIDIOC_ENUM_FRAMESIZES, &frmsize) == 0) {
+            // 记下来，set_format 时按策略挑一个
+            CaptureMode mode;
+            memset(&mode, 0, sizeof(mode));
+            mode.pixelformat = fmt.pixelformat;
+
             if (frmsize.type == V4L2_FRMSIZE_TYPE_DISCRETE) {
+                mode.width = mode.min_width = mode.max_width = frmsize.discrete.width;
+                mode.height = mode.min_height = mode.max_height = frmsize.discrete.height;
+                mode.step_width = mode.step_height = 1;
+                mode.max_fps = query_max_fps(fmt.pixelformat, mode.width, mode.height);
                 // 离散分辨率 
                 cout << "    - 分辨率: " << frmsize.discrete.width 
-                     << "x" << frmsize.discrete.height << endl;
+                     << "x" << frmsize.discrete.height;
+                if (mode.max_fps > 0) cout << " @ " << mode.max_fps << "fps";
+                cout << endl;
             } else if (frmsize.type == V4L2_FRMSIZE_TYPE_STEPWISE || 
                      frmsize.type == V4L2_FRMSIZE_TYPE_CONTINUOUS) {
+                mode.is_range = true;
+                mode.min_width = frmsize.stepwise.min_width;
+                mode.min_height = frmsize.stepwise.min_height;
+                mode.width = mode.max_width = frmsize.stepwise.max_width;
+                mode.height = mode.max_height = frmsize.stepwise.max_height;
+                mode.step_width = frmsize.stepwise.step_width ? frmsize.stepwise.step_width : 1;
+                mode.step_height = frmsize.stepwise.step_height ? frmsize.stepwise.step_height : 1;
+                mode.max_fps = query_max_fps(fmt.pixelformat, mode.width, mode.height);
                 // 范围分辨率
                 cout << "    - [范围] " 
                      << frmsize.stepwise.min_width << "x" << frmsize.stepwise.min_height
@@ -102,56 +159,196 @@ int query_device_info(const char* dev_name) {
                      << " (对齐: " << frmsize.stepwise.step_width << "x" << frmsize.stepwise.step_height << ")" 
                      << endl;
             }
+            if (mode.width > 0) modes_.push_back(mode);
             frmsize.index++;
         }
     }
-    return fd;
+    return fd_;
+}
+
+// 某个格式+分辨率下驱动支持的最高帧率 (帧间隔最小)，查不到返回 0
+double V4L2Device::query_max_fps(uint32_t pixelformat, uint32_t width, uint32_t height) {
+    struct v4l2_frmivalenum ival;
+    memset(&ival, 0, sizeof(ival));
+    ival.pixel_format = pixelformat;
+    ival.width = width;
+    ival.height = height;
+
+    double best = 0;
+    for (ival.index = 0; ioctl(fd_, VIDIOC_ENUM_FRAMEINTERVALS, &ival) == 0; ival.index++) {
+        struct v4l2_fract f;
+        if (ival.type == V4L2_FRMIVAL_TYPE_DISCRETE) {
+            f = ival.discrete;
+        } else {
+            // 范围型：最小间隔就是最高帧率，只有一项
+            f = ival.stepwise.min;
+        }
+        if (f.numerator > 0) {
+            double fps = (double)f.denominator / f.numerator;
+            if (fps > best) best = fps;
+        }
+        if (ival.type != V4L2_FRMIVAL_TYPE_DISCRETE) break;
+    }
+    return best;
+}
+
+// 格式优先级：越靠前需要的转换越少
+// H.264 直接转发 (只有开了直通才会 accept)；NV12 就是编码器的输入格式；
+// YUYV 要 RGA 转一次；MJPEG 还要先解码
+static const uint32_t FORMAT_PREFERENCE[] = {
+    V4L2_PIX_FMT_H264,
+    V4L2_PIX_FMT_NV12,
+    V4L2_PIX_FMT_YUYV,
+    V4L2_PIX_FMT_MJPEG,
+};
+
+int V4L2Device::select_mode(int width, int height, int fps, CaptureMode* out) const {
+    // 排序键：分辨率够不够 -> 帧率够不够 -> 格式优先级 -> 分辨率是否正好 -> 最高帧率 -> 缩放量
+    // 分辨率和帧率放在格式前面：USB 摄像头 1080p 的 YUYV 往往只有 5 帧，
+    // 宁可多一次 MJPEG 解码，也要拿到 1080p30
+    struct Rank {
+        int undersized;
+        int fps_short;
+        int format;
+        int not_exact;
+        double neg_fps;
+        long long size_cost;
+        bool operator<(const Rank& o) const {
+            if (undersized != o.undersized) return undersized < o.undersized;
+            if (fps_short != o.fps_short) return fps_short < o.fps_short;
+            if (format != o.format) return format < o.format;
+            if (not_exact != o.not_exact) return not_exact < o.not_exact;
+            if (neg_fps != o.neg_fps) return neg_fps < o.neg_fps;
+            return size_cost < o.size_cost;
+        }
+    };
+
+    const int pref_count = sizeof(FORMAT_PREFERENCE) / sizeof(FORMAT_PREFERENCE[0]);
+    bool found = false;
+    Rank best = {0, 0, 0, 0, 0, 0};
+    long long target_area = (long long)width * height;
+
+    for (const CaptureMode& m : modes_) {
+        // 1. 格式：必须是调用方能处理的，按 FORMAT_PREFERENCE 排
+        int format_rank = -1;
+        for (int i = 0; i < pref_count; ++i) {
+            if (FORMAT_PREFERENCE[i] == m.pixelformat) { format_rank = i; break; }
+        }
+        if (format_rank < 0) continue;
+        bool accepted = false;
+        for (uint32_t f : accepted_formats_) {
+            if (f == m.pixelformat) { accepted = true; break; }
+        }
+        if (!accepted) continue;
+
+        // 2. 分辨率：范围型能设成目标尺寸就算正好，否则取最接近的
+        CaptureMode cand = m;
+        if (m.is_range) {
+            uint32_t w = std::min(std::max((uint32_t)width, m.min_width), m.max_width);
+            uint32_t h = std::min(std::max((uint32_t)height, m.min_height), m.max_height);
+            cand.width = w - (w - m.min_width) % m.step_width;
+            cand.height = h - (h - m.min_height) % m.step_height;
+        }
+        bool exact = ((int)cand.width == width && (int)cand.height == height);
+        // 缩放量：宁可比目标大 (RGA 缩小)，不要比目标小 (放大会糊)
+        long long area = (long long)cand.width * cand.height;
+        bool covers = ((int)cand.width >= width && (int)cand.height >= height);
+        long long size_cost = covers ? area - target_area : target_area - area;
+
+        // 3. 帧率：能达到目标帧率的优先，再看最高帧率 (0 表示驱动没报，当作能达到)
+        bool fps_ok = (m.max_fps <= 0 || m.max_fps + 0.5 >= fps);
+
+        Rank r = {covers ? 0 : 1, fps_ok ? 0 : 1, format_rank, exact ? 0 : 1, -m.max_fps, size_cost};
+        if (!found || r < best) {
+            best = r;
+            *out = cand;
+            found = true;
+        }
+    }
+    return found ? 0 : -1;
 }
 
-int open_camera(int fd, int width, int height,int fps) {
+void V4L2Device::set_accepted_formats(const std::vector<uint32_t>& formats) {
+    accepted_formats_ = formats;
+}
+
+int V4L2Device::set_format(int width, int height,int fps) {
 
     // 先查询一次 Capability，确定是 USB 还是 MIPI
     struct v4l2_capability cap;
-    if (ioctl(fd, VIDIOC_QUERYCAP, &cap) < 0) {
+    if (ioctl(fd_, VIDIOC_QUERYCAP, &cap) < 0) {
         perror("查询能力失败");
         return -1;
     }
 
     if (cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE) {
-        g_buf_type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE; // MIPI 改用 MPLANE
+        buf_type_ = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE; // MIPI 改用 MPLANE
         std::cout << ">>[V4L2] 模式: Multi-Planar (MPLANE)" << std::endl;
     } else {
-        g_buf_type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf_type_ = V4L2_BUF_TYPE_VIDEO_CAPTURE;
         std::cout << ">>[V4L2] 模式: Single-Planar" << std::endl;
     }
 
-    // 2. 设置格式 (VIDIOC_S_FMT)
+    // 2. 按枚举结果挑格式/分辨率 (需要的转换越少越好)
+    //    驱动没报能力的话，退回老规矩：MIPI 用 NV12，USB 用 YUYV
+    CaptureMode mode;
+    memset(&mode, 0, sizeof(mode));
+    if (select_mode(width, height, fps, &mode) == 0) {
+        char fourcc[5] = {0};
+        *(uint32_t*)fourcc = mode.pixelformat;
+        printf(">>[V4L2] 协商结果: %s %ux%u (目标 %dx%d)", fourcc, mode.width, mode.height, width, height);
+        if (mode.max_fps > 0) printf(" 最高 %.1f fps", mode.max_fps);
+        printf("\n");
+    } else {
+        mode.pixelformat = (buf_type_ == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+                               ? V4L2_PIX_FMT_NV12 : V4L2_PIX_FMT_YUYV;
+        mode.width = width;
+        mode.height = height;
+        printf(">>[V4L2] 没有可用的枚举结果，使用默认格式\n");
+    }
+
+    // 3. 设置格式 (VIDIOC_S_FMT)
     struct v4l2_format fmt;
     memset(&fmt, 0, sizeof(fmt));
-    fmt.type = g_buf_type; 
+    fmt.type = buf_type_; 
 
-    if (g_buf_type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
+    if (buf_type_ == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
         // --- MIPI (MPLANE) 设置方式 ---
-        fmt.fmt.pix_mp.width = width;
-        fmt.fmt.pix_mp.height = height;
-        fmt.fmt.pix_mp.pixelformat = V4L2_PIX_FMT_NV12; // 推荐 NV12
+        fmt.fmt.pix_mp.width = mode.width;
+        fmt.fmt.pix_mp.height = mode.height;
+        fmt.fmt.pix_mp.pixelformat = mode.pixelformat;
         fmt.fmt.pix_mp.field = V4L2_FIELD_NONE;
         // fmt.fmt.pix_mp.num_planes = 1; // 通常驱动会自动修正，不写也行
     } else {
         // --- USB (Single-Plane) 设置方式 ---
-        fmt.fmt.pix.width = width;
-        fmt.fmt.pix.height = height;
-        fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV; 
+        fmt.fmt.pix.width = mode.width;
+        fmt.fmt.pix.height = mode.height;
+        fmt.fmt.pix.pixelformat = mode.pixelformat; 
         fmt.fmt.pix.field = V4L2_FIELD_NONE;
     }
 
-    if (ioctl(fd, VIDIOC_S_FMT, &fmt) < 0) {
+    if (ioctl(fd_, VIDIOC_S_FMT, &fmt) < 0) {
         perror(">>[V4L2] 设置格式失败 (S_FMT)");
         return -1;
     }
 
+    // 记下驱动实际给的格式 (DMABUF 模式要按它检查外部内存的布局)
+    if (buf_type_ == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
+        fmt_pixelformat_ = fmt.fmt.pix_mp.pixelformat;
+        fmt_width_ = fmt.fmt.pix_mp.width;
+        fmt_height_ = fmt.fmt.pix_mp.height;
+        fmt_bytesperline_ = fmt.fmt.pix_mp.plane_fmt[0].bytesperline;
+        fmt_sizeimage_ = fmt.fmt.pix_mp.plane_fmt[0].sizeimage;
+    } else {
+        fmt_pixelformat_ = fmt.fmt.pix.pixelformat;
+        fmt_width_ = fmt.fmt.pix.width;
+        fmt_height_ = fmt.fmt.pix.height;
+        fmt_bytesperline_ = fmt.fmt.pix.bytesperline;
+        fmt_sizeimage_ = fmt.fmt.pix.sizeimage;
+    }
+
     // 打印实际结果 
-    if (g_buf_type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
+    if (buf_type_ == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
         cout << ">>[V4L2-MIPI] 设置分辨率: " << fmt.fmt.pix_mp.width << "x" << fmt.fmt.pix_mp.height << endl;
         char fourcc[5] = {0};
         *(int*)fourcc = fmt.fmt.pix_mp.pixelformat;
@@ -163,15 +360,19 @@ int open_camera(int fd, int width, int height,int fps) {
         cout << ">>[V4L2-USB] 像素格式: " << fourcc << endl;
     }
 
-    // 3. 设置帧率 
+    // 4. 设置帧率 (不超过这个模式支持的最高帧率)
+    if (mode.max_fps > 0 && fps > mode.max_fps + 0.5) {
+        printf(">>[V4L2] 目标帧率 %d 超过该模式上限 %.1f\n", fps, mode.max_fps);
+        fps = (int)(mode.max_fps + 0.5);
+    }
     struct v4l2_streamparm streamparm;
     memset(&streamparm, 0, sizeof(streamparm));
-    streamparm.type = g_buf_type; 
+    streamparm.type = buf_type_; 
     
     streamparm.parm.capture.timeperframe.numerator = 1;
     streamparm.parm.capture.timeperframe.denominator = fps;
 
-    if (ioctl(fd, VIDIOC_S_PARM, &streamparm) == 0) {
+    if (ioctl(fd_, VIDIOC_S_PARM, &streamparm) == 0) {
         printf(">>[V4L2] 最终驱动帧率: %u/%u fps\n", 
             streamparm.parm.capture.timeperframe.denominator,
             streamparm.parm.capture.timeperframe.numerator);
@@ -182,51 +383,52 @@ int open_camera(int fd, int width, int height,int fps) {
     return 0;
 }
 
-CameraBuffer* map_buffers(int fd, int* count) {
+int V4L2Device::map_buffers(int count) {
     // 1. 向内核申请缓冲区 (REQBUFS)
     struct v4l2_requestbuffers req;
     memset(&req, 0, sizeof(req));
-    req.count = *count;                 // 期望申请的数量 (比如 4)
-    req.type = g_buf_type;
+    req.count = count;                  // 期望申请的数量 (比如 4)
+    req.type = buf_type_;
     req.memory = V4L2_MEMORY_MMAP;      // 使用内存映射模式
 
-    if (ioctl(fd, VIDIOC_REQBUFS, &req) < 0) {
+    if (ioctl(fd_, VIDIOC_REQBUFS, &req) < 0) {
         perror(">>[V4L2] REQBUFS 失败");
-        return nullptr;
+        return -1;
     }
+    memory_ = V4L2_MEMORY_MMAP;
+    dmabuf_fds_.clear();
 
     // 驱动可能申请不到 4 个，只给了 2 个，所以要更新 count
     if (req.count < 2) {
         std::cerr << ">>[V4L2] 缓冲区数量不足 (" << req.count << ")" << std::endl;
-        return nullptr;
+        return -1;
     }
-    *count = req.count;
+    buffer_count_ = req.count;
     std::cout << ">>[V4L2] 成功申请缓冲区数量: " << req.count << std::endl;
 
-    // 2. 分配用户空间的管理数组
-    // 我们用 new 动态分配一个数组，记得最后要 delete[]
-    CameraBuffer* buffers = new CameraBuffer[req.count];
-    memset(buffers, 0, sizeof(CameraBuffer) * req.count);
+    // 2. 分配用户空间的管理数组 (close_device 时统一释放)
+    buffers_.assign(req.count, CameraBuffer{nullptr, 0, -1, 0});
+    CameraBuffer* buffers = buffers_.data();
 
     // 3. 逐个查询、映射、导出 (QUERYBUF -> MMAP -> EXPBUF)
-    for (int i = 0; i < req.count; ++i) {
+    for (int i = 0; i < (int)req.count; ++i) {
         struct v4l2_buffer buf;
         memset(&buf, 0, sizeof(buf));
-        buf.type = g_buf_type;
+        buf.type = buf_type_;
         buf.memory = V4L2_MEMORY_MMAP;
         buf.index = i;
 
        // MPLANE 特殊处理：length 和 offset 位置不同
-        if (g_buf_type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
+        if (buf_type_ == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
             // MPLANE 需要分配 planes 数组
             struct v4l2_plane planes[1]; 
             memset(planes, 0, sizeof(planes));
             buf.m.planes = planes;
             buf.length = 1; // plane 数量
 
-            if (ioctl(fd, VIDIOC_QUERYBUF, &buf) < 0) {
+            if (ioctl(fd_, VIDIOC_QUERYBUF, &buf) < 0) {
                 perror(">>[V4L2] QUERYBUF (MPLANE) 失败");
-                return nullptr;
+                return -1;
             }
             
             buffers[i].index = i;
@@ -234,36 +436,37 @@ CameraBuffer* map_buffers(int fd, int* count) {
             
             buffers[i].start = mmap(NULL, buf.m.planes[0].length,
                                     PROT_READ | PROT_WRITE, MAP_SHARED,
-                                    fd, buf.m.planes[0].m.mem_offset); // offset 在 plane 里
+                                    fd_, buf.m.planes[0].m.mem_offset); // offset 在 plane 里
         } 
         else {
             // 普通模式
-            if (ioctl(fd, VIDIOC_QUERYBUF, &buf) < 0) {
+            if (ioctl(fd_, VIDIOC_QUERYBUF, &buf) < 0) {
                 perror(">>[V4L2] QUERYBUF 失败");
-                return nullptr;
+                return -1;
             }
             buffers[i].index = i;
             buffers[i].length = buf.length;
             buffers[i].start = mmap(NULL, buf.length,
                                     PROT_READ | PROT_WRITE, MAP_SHARED,
-                                    fd, buf.m.offset);
+                                    fd_, buf.m.offset);
         }
         if (buffers[i].start == MAP_FAILED) {
             perror(">>[V4L2] mmap 失败");
-            return nullptr;
+            buffers[i].start = nullptr;
+            return -1;
         }
 
         // C. 导出 DMA-BUF (Export DMA)
         struct v4l2_exportbuffer expbuf;
         memset(&expbuf, 0, sizeof(expbuf));
-        expbuf.type = g_buf_type;
+        expbuf.type = buf_type_;
         expbuf.index = i;
 
-        if (g_buf_type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
+        if (buf_type_ == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
             expbuf.plane = 0; 
         }
 
-        if (ioctl(fd, VIDIOC_EXPBUF, &expbuf) < 0) {
+        if (ioctl(fd_, VIDIOC_EXPBUF, &expbuf) < 0) {
             perror(">>[V4L2] EXPBUF (DMA-BUF导出) 失败");
             // 如果不支持 EXPBUF，这里可以置为 -1，后续就要走 CPU 拷贝了
             buffers[i].export_fd = -1;
@@ -274,43 +477,89 @@ CameraBuffer* map_buffers(int fd, int* count) {
     }
     
     std::cout << ">>[V4L2] 缓冲区映射 & DMA导出 完成" << std::endl;
-    return buffers;
+    return buffer_count_;
 }
 
-void release_buffers(CameraBuffer* buffers, int count) {
-    if (!buffers) return;
-    for (int i = 0; i < count; ++i) {
+void V4L2Device::release_buffers() {
+    if (buffers_.empty()) return;
+    for (CameraBuffer& b : buffers_) {
         // 解除映射
-        if (buffers[i].start) {
-            munmap(buffers[i].start, buffers[i].length);
+        // RGA 可能缓存了这块内存的句柄 (按地址或导出的 fd)
+        if (b.start) {
+            rga_release_virt(b.start);
+            munmap(b.start, b.length);
         }
         // 关闭 DMA-BUF fd
-        if (buffers[i].export_fd >= 0) {
-            close(buffers[i].export_fd);
+        if (b.export_fd >= 0) {
+            rga_release_fd(b.export_fd);
+            close(b.export_fd);
         }
     }
-    delete[] buffers;
+    buffers_.clear();
     std::cout << ">>[V4L2] 缓冲区资源已释放" << std::endl;
 }
 
-int start_capturing(int fd, int buffer_count) {
-    for (int i = 0; i < buffer_count; ++i) {
+void V4L2Device::close_device() {
+    if (fd_ < 0) return;
+    if (streaming_) stop_capturing();
+    release_buffers();
+
+    // 归还内核缓冲
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count = 0;
+    req.type = buf_type_;
+    req.memory = memory_;
+    ioctl(fd_, VIDIOC_REQBUFS, &req);
+
+    close(fd_);
+    fd_ = -1;
+    buffer_count_ = 0;
+    dmabuf_fds_.clear();
+    memory_ = V4L2_MEMORY_MMAP;
+}
+
+int V4L2Device::import_dmabufs(const int* dma_fds, int count, size_t length) {
+    if (!dma_fds || count <= 0) return -1;
+
+    // 1. 按 DMABUF 方式申请 (驱动只建队列，不分配内存)
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count = count;
+    req.type = buf_type_;
+    req.memory = V4L2_MEMORY_DMABUF;
+
+    if (ioctl(fd_, VIDIOC_REQBUFS, &req) < 0) {
+        perror(">>[V4L2] REQBUFS (DMABUF) 失败");
+        return -1;
+    }
+    if (req.count < 2 || (int)req.count > count) {
+        std::cerr << ">>[V4L2] DMABUF 缓冲区数量不对 (" << req.count << ")" << std::endl;
+        req.count = 0;
+        ioctl(fd_, VIDIOC_REQBUFS, &req);
+        return -1;
+    }
+
+    // 2. 记下 index -> fd 的对应关系，之后每次 QBUF 都要带上
+    dmabuf_fds_.assign(dma_fds, dma_fds + req.count);
+    dmabuf_length_ = length;
+    memory_ = V4L2_MEMORY_DMABUF;
+    buffer_count_ = req.count;
+
+    std::cout << ">>[V4L2] DMABUF 导入模式，缓冲区数量: " << req.count
+              << " 单块大小: " << length << std::endl;
+    return req.count;
+}
+
+int V4L2Device::start_capturing() {
+    for (int i = 0; i < buffer_count_; ++i) {
         struct v4l2_buffer buf;
         memset(&buf, 0, sizeof(buf));
-        buf.type = g_buf_type;
-        buf.memory = V4L2_MEMORY_MMAP;
-        buf.index = i;
-
-        if (g_buf_type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
-            struct v4l2_plane planes[1];
-            memset(planes, 0, sizeof(planes));
-            buf.m.planes = planes;
-            buf.length = 1;
-            planes[0].bytesused = 0;
-            planes[0].length = 0;
-        }
+        struct v4l2_plane planes[1];
+        memset(planes, 0, sizeof(planes));
+        fill_buffer(&buf, planes, i);
 
-        if (ioctl(fd, VIDIOC_QBUF, &buf) < 0) {
+        if (ioctl(fd_, VIDIOC_QBUF, &buf) < 0) {
             perror(">>[V4L2] QBUF (入队) 失败");
             return -1;
         }
@@ -318,32 +567,42 @@ int start_capturing(int fd, int buffer_count) {
     std::cout << ">>[V4L2] 所有缓冲区已入队 (QBUF Done)" << std::endl;
 
     // 2. 开启视频流 (STREAMON)
-    enum v4l2_buf_type type = (v4l2_buf_type)g_buf_type;
-    if (ioctl(fd, VIDIOC_STREAMON, &type) < 0) {
+    enum v4l2_buf_type type = (v4l2_buf_type)buf_type_;
+    if (ioctl(fd_, VIDIOC_STREAMON, &type) < 0) {
         perror(">>[V4L2] STREAMON (开启流) 失败");
         return -1;
     }
+    streaming_ = true;
     std::cout << ">>[V4L2] 视频流已开启 (STREAMON)" << std::endl;
     return 0;
 }
 
-void stop_capturing(int fd) {
-    enum v4l2_buf_type type = (v4l2_buf_type)g_buf_type;
-    ioctl(fd, VIDIOC_STREAMOFF, &type);
+void V4L2Device::stop_capturing() {
+    if (!streaming_) return;
+    enum v4l2_buf_type type = (v4l2_buf_type)buf_type_;
+    ioctl(fd_, VIDIOC_STREAMOFF, &type);
+    streaming_ = false;
     std::cout << ">>[V4L2] 视频流已停止" << std::endl;
 }
 
-int wait_and_get_frame(int fd) {
+// 单调时钟 (微秒)，驱动时间戳不可用时兜底
+static int64_t monotonic_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int V4L2Device::wait_and_get_frame(FrameInfo* info) {
     // A. 使用 select 等待数据可读 (超时时间 2秒)
     fd_set fds;
     FD_ZERO(&fds);
-    FD_SET(fd, &fds);
+    FD_SET(fd_, &fds);
 
     struct timeval tv;
     tv.tv_sec = 2; // 2秒超时
     tv.tv_usec = 0;
 
-    int r = select(fd + 1, &fds, NULL, NULL, &tv);
+    int r = select(fd_ + 1, &fds, NULL, NULL, &tv);
     if (r == -1) {
        // perror(">>[V4L2] select 错误");
         return -1;
@@ -353,51 +612,76 @@ int wait_and_get_frame(int fd) {
     }
 
     // B. 数据来了！执行出队操作 (DQBUF)
+    int index = dequeue_frame(info);
+    if (index == -2) {
+        perror(">>[V4L2] DQBUF (取帧) 失败");
+        return -1;
+    }
+    return index;
+}
+
+int V4L2Device::dequeue_frame(FrameInfo* info) {
     struct v4l2_buffer buf;
     memset(&buf, 0, sizeof(buf));
     
     struct v4l2_plane planes[1];
     memset(planes, 0, sizeof(planes));
 
-    buf.type = g_buf_type;
-    buf.memory = V4L2_MEMORY_MMAP;
+    buf.type = buf_type_;
+    buf.memory = memory_;
 
     // MPLANE 需要挂载 planes 接收信息
-    if (g_buf_type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
+    if (buf_type_ == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
         buf.m.planes = planes;
         buf.length = 1;
     }
 
-    if (ioctl(fd, VIDIOC_DQBUF, &buf) < 0) {
-        perror(">>[V4L2] DQBUF (取帧) 失败");
-        return -1;
+    // fd 是 O_NONBLOCK 打开的，没有帧时返回 EAGAIN
+    if (ioctl(fd_, VIDIOC_DQBUF, &buf) < 0) {
+        return (errno == EAGAIN) ? -1 : -2;
+    }
+
+    if (info) {
+        info->index = buf.index;
+        info->sequence = buf.sequence;
+        info->bytesused = (buf_type_ == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+                              ? planes[0].bytesused : buf.bytesused;
+        // 只有单调时钟的时间戳才能直接当 PTS 用，否则退回到出队时刻
+        if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+            info->timestamp_us = (int64_t)buf.timestamp.tv_sec * 1000000 + buf.timestamp.tv_usec;
+        } else {
+            info->timestamp_us = monotonic_us();
+        }
     }
 
     // 返回当前帧的索引 (0~3)
     return buf.index;
 }
 
-int return_frame(int fd, int index) {
+int V4L2Device::return_frame(int index) {
     struct v4l2_buffer buf;
     memset(&buf, 0, sizeof(buf));
-    buf.type = g_buf_type;
-    buf.memory = V4L2_MEMORY_MMAP;
-    buf.index = index;
-
-    if (g_buf_type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
-        struct v4l2_plane planes[1];
-        memset(planes, 0, sizeof(planes));
-        buf.m.planes = planes;
-        buf.length = 1;
-    }
+    struct v4l2_plane planes[1];
+    memset(planes, 0, sizeof(planes));
+    fill_buffer(&buf, planes, index);
 
-    if (ioctl(fd, VIDIOC_QBUF, &buf) < 0) {
+    if (ioctl(fd_, VIDIOC_QBUF, &buf) < 0) {
         perror(">>[V4L2] QBUF (归还) 失败");
         return -1;
     }
     return 0;
 }
 
-int get_v4l2_buf_type() {
-    return g_buf_type;
+int V4L2Device::get_dma_fd(int index) const {
+    if (memory_ == V4L2_MEMORY_DMABUF) {
+        return (index >= 0 && index < (int)dmabuf_fds_.size()) ? dmabuf_fds_[index] : -1;
+    }
+    return (index >= 0 && index < (int)buffers_.size()) ? buffers_[index].export_fd : -1;
+}
+
+void V4L2Device::get_format(uint32_t* width, uint32_t* height, uint32_t* bytesperline, uint32_t* sizeimage) const {
+    if (width) *width = fmt_width_;
+    if (height) *height = fmt_height_;
+    if (bytesperline) *bytesperline = fmt_bytesperline_;
+    if (sizeimage) *sizeimage = fmt_sizeimage_;
 }
@@ -0,0 +1,163 @@
+#include "video/v4l2_source.h"
+#include "video/rga.h"
+#include <iostream>
+
+using namespace std;
+
+V4L2FrameSource::V4L2FrameSource(const std::string& dev_name, int buffer_count, JpegDecoder* decoder)
+    : dev_name_(dev_name), buffer_count_(buffer_count), decoder_(decoder) {}
+
+V4L2FrameSource::~V4L2FrameSource() {
+    stop();
+    delete decoder_;
+    decoder_ = nullptr;
+}
+
+int V4L2FrameSource::open(int width, int height, int fps) {
+    if (camera_.open_device(dev_name_.c_str()) < 0) {
+        cerr << ">>[V4L2] 无法打开摄像头设备: " << dev_name_ << endl;
+        return -1;
+    }
+    // 有解码器才把 MJPEG 加进候选，协商时按帧率/分辨率和 YUYV 比
+    // 开了直通才把 H264 加进候选，够分辨率/帧率的话优先用它
+    std::vector<uint32_t> formats = {V4L2_PIX_FMT_NV12, V4L2_PIX_FMT_YUYV};
+    if (decoder_) formats.push_back(V4L2_PIX_FMT_MJPEG);
+    if (allow_h264_) formats.push_back(V4L2_PIX_FMT_H264);
+    camera_.set_accepted_formats(formats);
+    if (camera_.set_format(width, height, fps) < 0) {
+        return -1;
+    }
+    cout << ">>[V4L2] 摄像头打开成功: " << dev_name_ << endl;
+
+    if (camera_.get_pixelformat() == V4L2_PIX_FMT_NV12) {
+        printf(">>[V4L2] 源模式: NV12 (编码器原生格式)\n");
+    } else if (camera_.get_pixelformat() == V4L2_PIX_FMT_YUYV) {
+        printf(">>[V4L2] 源模式: YUYV (RGA 转换)\n");
+    } else if (camera_.get_pixelformat() == V4L2_PIX_FMT_MJPEG && decoder_) {
+        // 解码输出内存按实际协商到的分辨率分配
+        if (decoder_->init(get_width(), get_height(), buffer_count_) < 0) {
+            cerr << ">>[V4L2] MJPEG 解码器初始化失败: " << decoder_->get_name() << endl;
+            return -1;
+        }
+        mjpeg_ = true;
+        slot_in_use_.assign(buffer_count_, false);
+        printf(">>[V4L2] 源模式: MJPEG (%s 解码 + RGA 转换)\n", decoder_->get_name());
+    } else if (camera_.get_pixelformat() == V4L2_PIX_FMT_H264 && allow_h264_) {
+        // 码流一帧都不能丢，采集线程改成按顺序排队
+        h264_ = true;
+        capture_.set_max_pending(buffer_count_);
+        printf(">>[V4L2] 源模式: H.264 直通 (不经过 RGA/编码器)\n");
+    } else {
+        cerr << ">>[V4L2] 协商出的像素格式无法处理" << endl;
+        return -1;
+    }
+    return 0;
+}
+
+int V4L2FrameSource::start() {
+    // 没有导入外部 dma-buf 的话，映射驱动自己的内存
+    if (camera_.get_buffer_count() == 0) {
+        if (camera_.map_buffers(buffer_count_) < 0) {
+            cerr << ">>[V4L2] 映射缓冲区失败" << endl;
+            return -1;
+        }
+    }
+    if (camera_.start_capturing() < 0) {
+        return -1;
+    }
+    cout << ">>[V4L2] 摄像头初始化成功" << endl;
+
+    // 采集放到独立线程，处理慢了也不会饿着驱动
+    if (capture_.start(&camera_) < 0) {
+        cerr << ">>[V4L2] 采集线程启动失败" << endl;
+        return -1;
+    }
+    return 0;
+}
+
+void V4L2FrameSource::stop() {
+    // 先停采集线程 (会归还它手里的帧)，再关流
+    capture_.stop();
+    camera_.stop_capturing();
+}
+
+bool V4L2FrameSource::acquire(SourceFrame* frame, int timeout_ms) {
+    FrameInfo info;
+    if (!capture_.acquire(&info, timeout_ms)) return false;
+
+    if (mjpeg_) {
+        // 采集线程只留最新一帧，旧的 JPEG 根本不会被解，慢了也不浪费解码器
+        int slot = -1;
+        for (int i = 0; i < (int)slot_in_use_.size(); ++i) {
+            if (!slot_in_use_[i]) { slot = i; break; }
+        }
+        DecodedFrame dec;
+        int ret = -1;
+        if (slot >= 0) {
+            ret = decoder_->decode(camera_.get_buffer(info.index).start, info.bytesused, slot, &dec);
+        }
+        // 解完 (或者解不了) 马上把 JPEG 还给驱动
+        capture_.release(info.index);
+        if (ret < 0) {
+            if (++decode_errors_ % 30 == 1) {
+                cerr << ">>[V4L2] MJPEG 解码失败 (累计 " << decode_errors_ << " 帧)" << endl;
+            }
+            return false;
+        }
+        slot_in_use_[slot] = true;
+
+        frame->index = slot;
+        frame->dma_fd = dec.dma_fd;
+        frame->virt = dec.virt;
+        frame->size = info.bytesused;
+        frame->format = dec.format;
+        frame->hor_stride = dec.hor_stride;
+        frame->ver_stride = dec.ver_stride;
+        frame->info = info;
+        return true;
+    }
+
+    uint32_t width = 0, height = 0, bytesperline = 0;
+    camera_.get_format(&width, &height, &bytesperline, nullptr);
+
+    frame->index = info.index;
+    frame->dma_fd = camera_.get_dma_fd(info.index);
+    frame->virt = (camera_.get_memory() == V4L2_MEMORY_MMAP)
+                      ? camera_.get_buffer(info.index).start : nullptr;
+    frame->size = info.bytesused;
+    frame->format = get_format();
+    // bytesperline 是字节数，YUYV 一个像素 2 字节
+    if (camera_.get_pixelformat() == V4L2_PIX_FMT_YUYV) bytesperline /= 2;
+    frame->hor_stride = (bytesperline >= width) ? (int)bytesperline : (int)width;
+    frame->ver_stride = (int)height;
+    frame->info = info;
+    return true;
+}
+
+void V4L2FrameSource::release(int index) {
+    if (mjpeg_) {
+        if (index >= 0 && index < (int)slot_in_use_.size()) slot_in_use_[index] = false;
+        return;
+    }
+    capture_.release(index);
+}
+
+int V4L2FrameSource::get_format() const {
+    if (mjpeg_) return decoder_->get_format();
+    if (h264_) return RK_FORMAT_UNKNOWN;
+    // V4L2 像素格式 -> RGA 格式
+    return (camera_.get_pixelformat() == V4L2_PIX_FMT_NV12)
+               ? RK_FORMAT_YCbCr_420_SP : RK_FORMAT_YUYV_422;
+}
+
+int V4L2FrameSource::get_width() const {
+    uint32_t w = 0;
+    camera_.get_format(&w, nullptr, nullptr, nullptr);
+    return (int)w;
+}
+
+int V4L2FrameSource::get_height() const {
+    uint32_t h = 0;
+    camera_.get_format(nullptr, &h, nullptr, nullptr);
+    return (int)h;
+}
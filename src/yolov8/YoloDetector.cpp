@@ -1,8 +1,10 @@
 #include "yolov8/YoloDetector.h"
+#include "video/dma_buf.h"
 #include <iostream>
 #include <fstream>
 #include <cstring>
 #include <cstdlib>
+#include <algorithm>
 
 static const char* COCO_LABELS[] = {
     "person", "bicycle", "car", "motorcycle", "airplane", "bus", "train", "truck", "boat", "traffic light",
@@ -24,6 +26,8 @@ YoloDetector::YoloDetector() {
 
 // 析构函数：释放所有资源
 YoloDetector::~YoloDetector() {
+    for (auto& entry : input_mems) rknn_destroy_mem(app_ctx.rknn_ctx, entry.second);
+    input_mems.clear();
     if (app_ctx.input_attrs) free(app_ctx.input_attrs);
     if (app_ctx.output_attrs) free(app_ctx.output_attrs);
     if (model_data) free(model_data);
@@ -98,24 +102,89 @@ int YoloDetector::init(const char* model_path) {
     return 0;
 }
 
-std::vector<Object> YoloDetector::detect(void* input_data) {
+int YoloDetector::bind_input_fd(int fd, void* virt) {
+    if (fd == bound_fd) return 0;
+
+    rknn_tensor_mem* mem = nullptr;
+    auto it = input_mems.find(fd);
+    if (it != input_mems.end()) {
+        mem = it->second;
+    } else {
+        uint32_t size = app_ctx.model_width * app_ctx.model_height * app_ctx.model_channel;
+        mem = rknn_create_mem_from_fd(app_ctx.rknn_ctx, fd, virt, size, 0);
+        if (!mem) {
+            printf("rknn_create_mem_from_fd failed! fd=%d\n", fd);
+            return -1;
+        }
+        input_mems[fd] = mem;
+    }
+
+    // 输入就是 RGA 出的 NHWC RGB，让 rknn 按这个格式读 (归一化/量化由 NPU 做)
+    rknn_tensor_attr attr = app_ctx.input_attrs[0];
+    attr.type = RKNN_TENSOR_UINT8;
+    attr.fmt = RKNN_TENSOR_NHWC;
+    attr.pass_through = 0;
+    int ret = rknn_set_io_mem(app_ctx.rknn_ctx, mem, &attr);
+    if (ret < 0) {
+        printf("rknn_set_io_mem failed! ret=%d\n", ret);
+        return -1;
+    }
+    bound_fd = fd;
+    return 0;
+}
+
+letterbox_t YoloDetector::make_letterbox(int src_w, int src_h) const {
+    letterbox_t lb;
+    lb.target_width = app_ctx.model_width;
+    lb.target_height = app_ctx.model_height;
+    float scale = std::min((float)lb.target_width / src_w, (float)lb.target_height / src_h);
+
+    // 缩放后的尺寸向下取到 "目标尺寸 - 4 的倍数"，这样两边边距相等且都是偶数
+    int new_w = std::min((int)(src_w * scale + 0.5f), lb.target_width);
+    int new_h = std::min((int)(src_h * scale + 0.5f), lb.target_height);
+    new_w -= (4 - (lb.target_width - new_w) % 4) % 4;
+    new_h -= (4 - (lb.target_height - new_h) % 4) % 4;
+    lb.x_pad = (lb.target_width - new_w) / 2;
+    lb.y_pad = (lb.target_height - new_h) / 2;
+    // RGA 实际是缩放到 new_w x new_h，换算回原图要用取整之后的比例 (两个方向可能差一点)
+    lb.scale_x = (float)new_w / src_w;
+    lb.scale_y = (float)new_h / src_h;
+    return lb;
+}
+
+std::vector<Object> YoloDetector::detect(void* input_data, int input_fd, const letterbox_t* letterbox) {
     std::vector<Object> results;
     int ret;
 
-    // 设置 input 
-    rknn_input inputs[1];
-    memset(inputs, 0, sizeof(inputs));
-    inputs[0].index = 0;
-    inputs[0].type = RKNN_TENSOR_UINT8; // 这里的类型要看你的模型量化类型，通常是 UINT8
-    inputs[0].size = app_ctx.model_width * app_ctx.model_height * app_ctx.model_channel;
-    inputs[0].fmt = RKNN_TENSOR_NHWC;   // RGA 输出的 RGB 也是 NHWC 排列
-    inputs[0].pass_through = 0;
-    inputs[0].buf = input_data;         // <--- 关键：直接挂载外部指针
-
-    ret = rknn_inputs_set(app_ctx.rknn_ctx, app_ctx.io_num.n_input, inputs);
-    if (ret < 0) {
-        printf("rknn_inputs_set failed! ret=%d\n", ret);
-        return results;
+    // 零拷贝：NPU 直接读 RGA 写好的内存
+    bool zero_copy = false;
+    if (input_fd >= 0 && !zero_copy_failed) {
+        zero_copy = (bind_input_fd(input_fd, input_data) == 0);
+        if (!zero_copy) {
+            zero_copy_failed = true;
+            printf(">>[AI] 零拷贝输入不可用，改用 rknn_inputs_set\n");
+        }
+    }
+
+    // 设置 input (非零拷贝时 rknn 从外部指针拷一份)
+    if (!zero_copy) {
+        // 输入在 dma-buf 里的话，CPU 拷贝前先同步缓存，才能看到 RGA 写的数据
+        DmaBufCpuAccess cpu_access(input_fd, DMA_BUF_SYNC_READ);
+        bound_fd = -1;
+        rknn_input inputs[1];
+        memset(inputs, 0, sizeof(inputs));
+        inputs[0].index = 0;
+        inputs[0].type = RKNN_TENSOR_UINT8; // 这里的类型要看你的模型量化类型，通常是 UINT8
+        inputs[0].size = app_ctx.model_width * app_ctx.model_height * app_ctx.model_channel;
+        inputs[0].fmt = RKNN_TENSOR_NHWC;   // RGA 输出的 RGB 也是 NHWC 排列
+        inputs[0].pass_through = 0;
+        inputs[0].buf = input_data;         // <--- 关键：直接挂载外部指针
+
+        ret = rknn_inputs_set(app_ctx.rknn_ctx, app_ctx.io_num.n_input, inputs);
+        if (ret < 0) {
+            printf("rknn_inputs_set failed! ret=%d\n", ret);
+            return results;
+        }
     }
 
     // 执行推理
@@ -131,11 +200,16 @@ std::vector<Object> YoloDetector::detect(void* input_data) {
 
     // 后处理
     letterbox_t lb;
-    lb.target_width = app_ctx.model_width;
-    lb.target_height = app_ctx.model_height;
-    lb.scale = 1.0f; 
-    lb.x_pad = 0;
-    lb.y_pad = 0;
+    if (letterbox) {
+        lb = *letterbox;
+    } else {
+        lb.target_width = app_ctx.model_width;
+        lb.target_height = app_ctx.model_height;
+        lb.scale_x = 1.0f;
+        lb.scale_y = 1.0f;
+        lb.x_pad = 0;
+        lb.y_pad = 0;
+    }
 
     // 2. 准备结果容器
     object_detect_result_list od_results;
@@ -149,7 +223,7 @@ std::vector<Object> YoloDetector::detect(void* input_data) {
         Object obj;
         obj.id = od_results.results[i].cls_id;
         obj.prob = od_results.results[i].prop;
-        // 这里的坐标是基于 640x640 的
+        // 有 letterbox 时已经是原图坐标，否则是 640x640 上的
         obj.x = od_results.results[i].box.left;
         obj.y = od_results.results[i].box.top;
         obj.w = od_results.results[i].box.right - od_results.results[i].box.left;
@@ -558,6 +558,10 @@ int post_process(rknn_app_context_t *app_ctx, void *outputs, letterbox_t *letter
     int last_count = 0;
     od_results->count = 0;
 
+    /* letterbox: clamp to the image area (without padding) before scaling back */
+    int content_w = model_in_w - 2 * letter_box->x_pad;
+    int content_h = model_in_h - 2 * letter_box->y_pad;
+
     /* box valid detect target */
     for (int i = 0; i < validCount; ++i)
     {
@@ -574,10 +578,10 @@ int post_process(rknn_app_context_t *app_ctx, void *outputs, letterbox_t *letter
         int id = classId[n];
         float obj_conf = objProbs[i];
 
-        od_results->results[last_count].box.left = (int)(clamp(x1, 0, model_in_w) / letter_box->scale);
-        od_results->results[last_count].box.top = (int)(clamp(y1, 0, model_in_h) / letter_box->scale);
-        od_results->results[last_count].box.right = (int)(clamp(x2, 0, model_in_w) / letter_box->scale);
-        od_results->results[last_count].box.bottom = (int)(clamp(y2, 0, model_in_h) / letter_box->scale);
+        od_results->results[last_count].box.left = (int)(clamp(x1, 0, content_w) / letter_box->scale_x);
+        od_results->results[last_count].box.top = (int)(clamp(y1, 0, content_h) / letter_box->scale_y);
+        od_results->results[last_count].box.right = (int)(clamp(x2, 0, content_w) / letter_box->scale_x);
+        od_results->results[last_count].box.bottom = (int)(clamp(y2, 0, content_h) / letter_box->scale_y);
         od_results->results[last_count].prop = obj_conf;
         od_results->results[last_count].cls_id = id;
         last_count++;